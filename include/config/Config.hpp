@@ -1,10 +1,23 @@
 #pragma once
 
+#include <map>
 #include <string>
 #include <vector>
 
 namespace SyncLayer::Config {
 
+// Apply scheduling for one table's lane (sync.lanes)
+struct LaneSettings {
+    int weight {1};
+    int maxLagMs {0}; // 0: no lag objective
+};
+
+// Connection count bounds for one pool role (pool.<role>)
+struct PoolSettings {
+    int min {0};
+    int max {1};
+};
+
 class Config {
 public:
     explicit Config(const std::string& path);
@@ -16,6 +29,24 @@ public:
     int getIntervalSeconds() const;
     int getBatchSize() const;
     bool getAutoFetch() const;
+    int getApplyWorkers() const;
+    std::string getApplyMode() const;
+    std::string getPipelineName() const;
+    int getQueueCapacity() const;
+    int getQueueMemoryMB() const;
+    std::string getQueueBackend() const;
+    std::string getQueueDir() const;
+    int getQueueSegmentMB() const;
+    std::string getSpillDir() const;
+    int getSpillMaxMB() const;
+    int getApplyBatchSize() const;
+    int getApplyBatchMB() const;
+    int getApplyMaxWaitMs() const;
+    int getSnapshotFetchRows() const;
+    int getStatementTimeoutMs() const;
+    int getLockTimeoutMs() const;
+    int getApplyTimeoutMs() const;
+    const std::map<std::string, LaneSettings>& getLanes() const;
     std::vector<std::string> getTables() const;
 
     std::string getLogLevel() const;
@@ -23,6 +54,10 @@ public:
 
     int getHealthPort() const;
 
+    // Keyed by role: capture, apply, copy, monitoring
+    const std::map<std::string, PoolSettings>& getPools() const;
+    int getPoolPingSeconds() const;
+
 private:
     void loadFromFile(const std::string& path);
 
@@ -32,10 +67,30 @@ private:
     int intervalSeconds_ {5};
     int batchSize_ {50};
     bool autoFetch_ {true};
+    int applyWorkers_ {1};
+    std::string applyMode_ {"hash"};
+    std::string pipelineName_ {"default"};
+    int queueCapacity_ {65536};
+    int queueMemoryMB_ {256};
+    std::string queueBackend_ {"memory"};
+    std::string queueDir_ {"data/queue"};
+    int queueSegmentMB_ {64};
+    std::string spillDir_ {"data/spill"};
+    int spillMaxMB_ {0};
+    int applyBatchSize_ {1000};
+    int applyBatchMB_ {16};
+    int applyMaxWaitMs_ {500};
+    int snapshotFetchRows_ {1000};
+    int statementTimeoutMs_ {30000};
+    int lockTimeoutMs_ {5000};
+    int applyTimeoutMs_ {60000};
+    std::map<std::string, LaneSettings> lanes_;
     std::vector<std::string> tables_;
     std::string logLevel_ {"info"};
     std::string logFile_ {"logs/synclayer.log"};
     int healthPort_ {8080};
+    std::map<std::string, PoolSettings> pools_;
+    int poolPingSeconds_ {30};
 };
 
 } // namespace SyncLayer::Config
@@ -17,6 +17,8 @@ public:
     explicit Engine(const std::string& configPath);
     ~Engine();
     void run();
+    // Ends a run() in progress at its next capture round; safe from a signal handler.
+    void stop();
 
 private:
     std::shared_ptr<SyncLayer::Config::Config> config_;
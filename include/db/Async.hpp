@@ -0,0 +1,136 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "EventLoop.hpp"
+#include "Result.hpp"
+
+namespace SyncLayer::DB {
+
+/**
+ * @brief Lazily started coroutine that produces a T.
+ *
+ * Nothing runs until the task is awaited from another task or start()ed.
+ * An awaiting task resumes as soon as this one finishes. Tasks are resumed
+ * from EventLoop callbacks, so a chain of them runs on the loop's thread
+ * and any number of chains interleave on one loop: each reads as
+ * sequential code while their round trips overlap.
+ */
+template <typename T>
+class Task {
+public:
+    struct promise_type {
+        std::optional<T> value;
+        std::exception_ptr error;
+        std::coroutine_handle<> continuation;
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        auto final_suspend() noexcept
+        {
+            // Hand control straight to whoever awaited this task, if anyone did
+            struct Resume {
+                bool await_ready() noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> done) noexcept
+                {
+                    auto next = done.promise().continuation;
+                    return next ? next : std::noop_coroutine();
+                }
+                void await_resume() noexcept {}
+            };
+            return Resume{};
+        }
+        template <typename U>
+        void return_value(U&& v) { value.emplace(std::forward<U>(v)); }
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task()
+    {
+        if (handle_) handle_.destroy();
+    }
+
+    // Runs the task up to its first suspension; the event loop resumes it from there.
+    void start() { handle_.resume(); }
+    bool done() const { return handle_ && handle_.done(); }
+    // The value of a finished task; rethrows whatever the coroutine threw.
+    T& result()
+    {
+        auto& promise = handle_.promise();
+        if (promise.error) std::rethrow_exception(promise.error);
+        return *promise.value;
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+    T await_resume() { return std::move(result()); }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+/**
+ * @brief Awaitable queries on one connection, driven by an EventLoop.
+ *
+ *     auto rows = co_await conn.query("SELECT ...");
+ *     auto done = co_await conn.copyOut("COPY t TO STDOUT", onRow);
+ *
+ * Each returns the first failed result of the statement, or its last
+ * result. A statement that can't even be sent returns a PGRES_FATAL_ERROR
+ * result carrying the connection's error, without suspending.
+ */
+class AsyncConnection {
+public:
+    AsyncConnection(EventLoop& loop, DBConnection* conn) : loop_(&loop), conn_(conn) {}
+
+    class Awaiter {
+    public:
+        Awaiter(EventLoop* loop, DBConnection* conn, std::string sql, EventLoop::RowSink onRow)
+            : loop_(loop), conn_(conn), sql_(std::move(sql)), onRow_(std::move(onRow)) {}
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> awaiting);
+        Result await_resume() { return std::move(result_); }
+
+    private:
+        EventLoop* loop_;
+        DBConnection* conn_;
+        std::string sql_;
+        EventLoop::RowSink onRow_;
+        Result result_;
+    };
+
+    Awaiter query(std::string sql) const { return Awaiter(loop_, conn_, std::move(sql), nullptr); }
+    Awaiter copyOut(std::string sql, EventLoop::RowSink onRow) const
+    {
+        return Awaiter(loop_, conn_, std::move(sql), std::move(onRow));
+    }
+    DBConnection* connection() const { return conn_; }
+
+private:
+    EventLoop* loop_;
+    DBConnection* conn_;
+};
+
+} // namespace SyncLayer::DB
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <libpq-fe.h>
+#include "RowView.hpp"
+#include "TypeCodec.hpp"
+
+namespace SyncLayer::DB {
+
+/**
+ * @brief Batch upsert as one statement with one array parameter per column.
+ *
+ *   INSERT INTO t (a, b) SELECT u.c1, u.c2::jsonb
+ *   FROM unnest($1::integer[], $2::text[]) AS u(c1, c2)
+ *   ON CONFLICT (a) DO UPDATE SET b = EXCLUDED.b
+ *
+ * The statement text does not depend on the row count, so it can be
+ * prepared once per table and reused for any batch size, and the bind
+ * parameter count is the column count rather than rows x columns. Columns
+ * with a TypeCodec encoder are sent as binary arrays of their own type; the
+ * rest travel as text[] and are cast per element in the select list.
+ */
+class BulkUpsert {
+public:
+    // Returns a view of the value at (row, column); see CellView for NULL.
+    using CellReader = std::function<CellView(int row, int column)>;
+    // Writes a whole column's array parameter into out; returns its format
+    // (1 = array_send binary, only for columns with an encoder; 0 = text literal).
+    using ArrayWriter = std::function<int(int column, std::string& out)>;
+
+    BulkUpsert(const std::string& table,
+               const std::vector<std::string>& columns,
+               const std::vector<Oid>& types,
+               const std::vector<std::string>& typeNames,
+               const std::vector<std::string>& primaryKey,
+               bool updateOnConflict);
+
+    const std::string& sql() const;
+    int paramCount() const;
+
+    // Encodes `rows` rows into the array parameters, reading each value in place.
+    void bind(int rows, const CellReader& cell);
+    // Binds arrays the caller already holds in columnar form.
+    void bindColumns(const ArrayWriter& write);
+    const char* const* values() const;
+    const int* lengths() const;
+    const int* formats() const;
+
+private:
+    bool bindBinary(int column, int rows, const CellReader& cell);
+    void bindText(int column, int rows, const CellReader& cell);
+    std::vector<Oid> types_;
+    std::vector<TypeCodec::Encoder> encoders_;
+    std::string sql_;
+    std::vector<std::string> buffers_;
+    std::vector<const char*> values_;
+    std::vector<int> lengths_;
+    std::vector<int> formats_;
+};
+
+} // namespace SyncLayer::DB
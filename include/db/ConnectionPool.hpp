@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "../config/Config.hpp"
+#include "DBConnection.hpp"
+#include "../utils/CircuitBreaker.hpp"
+
+namespace SyncLayer::DB {
+
+// What a connection is used for; each role is sized separately so that,
+// say, a health probe can never take the connection apply is waiting for.
+enum class Role { Capture, Apply, Copy, Monitoring };
+
+const char* roleName(Role role);
+
+/**
+ * @brief Bounded set of connections to one database, handed out as RAII leases.
+ *
+ * Each role keeps between `min` and `max` connections open. acquire() hands
+ * out an idle one, opens a new one while under `max`, or waits for a lease
+ * to come back. A returned connection goes back to the idle list only if it
+ * is still healthy and outside a transaction; otherwise it is closed. A
+ * background thread pings connections that have sat idle for a ping
+ * interval, drops the dead ones and tops each role back up to `min`.
+ * Missing connections are opened concurrently, so warming up costs about
+ * one handshake however many there are. The pool must outlive its leases.
+ */
+class ConnectionPool {
+public:
+    class Lease {
+    public:
+        Lease() = default;
+        ~Lease();
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        DBConnection* get() const { return conn_.get(); }
+        DBConnection* operator->() const { return conn_.get(); }
+        explicit operator bool() const { return conn_ != nullptr; }
+        // Hands the connection back to the pool now.
+        void reset();
+
+    private:
+        friend class ConnectionPool;
+        Lease(ConnectionPool* pool, Role role, std::unique_ptr<DBConnection> conn);
+
+        ConnectionPool* pool_ {nullptr};
+        Role role_ {Role::Monitoring};
+        std::unique_ptr<DBConnection> conn_;
+    };
+
+    // sizes is keyed by role name; roles it leaves out keep one connection at most.
+    // Nothing is opened until warmUp() or the first acquire().
+    ConnectionPool(std::string name, std::string conninfo,
+                   const std::map<std::string, SyncLayer::Config::PoolSettings>& sizes,
+                   std::chrono::seconds pingInterval);
+    ~ConnectionPool();
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    // Blocks until a connection for role is free; throws DatabaseError if it
+    // can't connect or none comes free within timeout.
+    Lease acquire(Role role, std::chrono::milliseconds timeout = std::chrono::seconds(30));
+    const std::string& name() const { return name_; }
+    // Shared by every retry against this database.
+    SyncLayer::Utils::CircuitBreaker& breaker() { return breaker_; }
+    // Sets name to value on every connection the pool opens from now on (and
+    // keeps it across their reconnects). Call before warmUp().
+    void setSessionParameter(const std::string& name, const std::string& value);
+
+    // Opens every pool's minimum connections at once; throws DatabaseError if any fails.
+    static void warmUp(const std::vector<ConnectionPool*>& pools,
+                       std::chrono::milliseconds timeout = std::chrono::seconds(30));
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Idle {
+        std::unique_ptr<DBConnection> conn;
+        Clock::time_point since;
+    };
+
+    struct Slot {
+        size_t min {0};
+        size_t max {1};
+        size_t open {0}; // idle plus leased
+        std::deque<Idle> idle;
+    };
+
+    void release(Role role, std::unique_ptr<DBConnection> conn);
+    void configure(DBConnection& conn) const;
+    // Concurrently opens what each pool is missing of its minimums; returns the first error, if any.
+    static std::string fill(const std::vector<ConnectionPool*>& pools, std::chrono::milliseconds timeout);
+    void pingIdle();
+    void run();
+
+    std::string name_;
+    std::string conninfo_;
+    std::chrono::seconds pingInterval_;
+    std::vector<std::pair<std::string, std::string>> session_;
+    SyncLayer::Utils::CircuitBreaker breaker_;
+    std::mutex mutex_;
+    std::condition_variable returned_;
+    std::condition_variable wake_;
+    std::array<Slot, 4> slots_;
+    bool stopping_ {false};
+    std::thread pinger_;
+};
+
+} // namespace SyncLayer::DB
@@ -2,6 +2,8 @@
 
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <libpq-fe.h>
 
@@ -11,6 +13,8 @@ class DBConnection {
 public:
     explicit DBConnection(const std::string& conninfo);
     ~DBConnection();
+    // Takes ownership of a connection that finished startup elsewhere (PQconnectStart/PQconnectPoll).
+    static std::unique_ptr<DBConnection> adopt(PGconn* conn);
 
     DBConnection(const DBConnection&) = delete;
     DBConnection& operator=(const DBConnection&) = delete;
@@ -21,8 +25,29 @@ public:
     bool isOpen() const;
     PGconn* raw();
 
+    // Session state is remembered and re-applied, in the order it was set up,
+    // whenever the connection is re-established.
+    bool setParameter(const std::string& name, const std::string& value);
+    bool prepare(const std::string& name, const std::string& sql, int nParams);
+    // Resets a dropped connection (CONNECTION_BAD) with backoff and restores
+    // its session; returns whether the connection is usable.
+    bool ensureConnected(int maxAttempts = 5);
+    unsigned reconnects() const { return reconnects_; }
+
 private:
+    struct Prepared {
+        std::string name;
+        std::string sql;
+        int nParams;
+    };
+
+    DBConnection() = default;
+    bool restoreSession();
+
     PGconn* conn_ {nullptr};
+    std::vector<std::pair<std::string, std::string>> settings_;
+    std::vector<Prepared> prepared_;
+    unsigned reconnects_ {0};
 };
 
 } // namespace SyncLayer::DB
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Result.hpp"
+
+namespace SyncLayer::DB {
+
+class DBConnection;
+
+/**
+ * @brief Single-threaded epoll reactor for nonblocking libpq connections.
+ *
+ * One thread calls run() and every handler and completion runs on it, so
+ * any number of connections can have a query in flight without a thread
+ * each. query() switches the connection to nonblocking mode, sends with
+ * PQsendQuery and then follows the socket: it waits for POLLOUT while
+ * PQflush has output left, and for POLLIN to PQconsumeInput and collect
+ * results once PQisBusy clears. copyOut() does the same for COPY ... TO
+ * STDOUT, handing each row to a callback as PQgetCopyData produces it.
+ * The connection goes back to blocking mode before the completion runs, so
+ * the caller can keep using it as usual.
+ *
+ * Watches are level-triggered. A handler may watch, modify or unwatch any
+ * descriptor, including its own.
+ */
+class EventLoop {
+public:
+    using Handler = std::function<void(std::uint32_t events)>;
+    // Every result of the query, in order; a connection failure shows up as a PGRES_FATAL_ERROR result.
+    using Completion = std::function<void(std::vector<Result>&& results)>;
+    // One COPY data row; the view is only valid during the call.
+    using RowSink = std::function<void(std::string_view row)>;
+    // The new connection, or null and the reason it failed.
+    using Connected = std::function<void(std::unique_ptr<DBConnection> conn, const std::string& error)>;
+
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // events is a mask of EPOLLIN / EPOLLOUT.
+    void watch(int fd, std::uint32_t events, Handler handler);
+    void modify(int fd, std::uint32_t events);
+    void unwatch(int fd);
+
+    // Starts sql on conn, which must have nothing else in flight; false if it could not be sent.
+    bool query(DBConnection* conn, const std::string& sql, Completion done);
+    // Starts a COPY ... TO STDOUT statement; rows go to onRow, then done gets the final results.
+    bool copyOut(DBConnection* conn, const std::string& sql, RowSink onRow, Completion done);
+    // Opens a connection without blocking (PQconnectStart/PQconnectPoll), so
+    // several can go through their TCP and TLS handshakes at once.
+    void connect(const std::string& conninfo, Connected done);
+
+    // Dispatches events until nothing is watched; false if timeout passed first.
+    bool run(std::chrono::milliseconds timeout = std::chrono::milliseconds::max());
+    size_t watched() const { return handlers_.size(); }
+
+private:
+    struct Connecting;
+
+    void pollConnect(const std::shared_ptr<Connecting>& state, PostgresPollingStatusType status);
+    bool start(DBConnection* conn, const std::string& sql, RowSink onRow, Completion done);
+
+    int epfd_ {-1};
+    std::unordered_map<int, std::shared_ptr<Handler>> handlers_;
+};
+
+} // namespace SyncLayer::DB
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <libpq-fe.h>
+#include "RowView.hpp"
+
+namespace SyncLayer::DB {
+
+// Whether an error with this SQLSTATE can go away by itself: connection
+// failures (class 08, or no SQLSTATE at all, which is how libpq reports a
+// lost connection), serialization failures and deadlocks (40001, 40P01),
+// lock timeouts (55P03), too many connections (53300) and server shutdown
+// (57P01-57P03). Anything else fails the same way every time.
+bool transientSqlstate(std::string_view sqlstate);
+// The transient failures that say the server itself is unreachable or going
+// away: class 08, no SQLSTATE, and server shutdown (57P01-57P03). Contention
+// (serialization failures, deadlocks, lock timeouts) says nothing about that.
+bool unavailableSqlstate(std::string_view sqlstate);
+
+/**
+ * @brief Owns a PGresult and clears it exactly once.
+ *
+ * Move-only. Values come back as CellViews into the result's own storage
+ * (no strlen, no copies) or parsed in place by get<T>(). Column lookups by
+ * name are cached, so resolving the same name per row costs one PQfnumber.
+ */
+class Result {
+public:
+    explicit Result(PGresult* res = nullptr) : res_(res) {}
+    ~Result() { PQclear(res_); }
+
+    Result(Result&& other) noexcept : res_(std::exchange(other.res_, nullptr)), names_(std::move(other.names_)) {}
+    Result& operator=(Result&& other) noexcept;
+    Result(const Result&) = delete;
+    Result& operator=(const Result&) = delete;
+
+    // Command or query completed (PGRES_COMMAND_OK or PGRES_TUPLES_OK).
+    bool ok() const;
+    ExecStatusType status() const { return PQresultStatus(res_); }
+    std::string_view error() const { return res_ ? PQresultErrorMessage(res_) : "no result"; }
+    // PG_DIAG_SQLSTATE of a failed result; empty when there is none.
+    std::string_view sqlstate() const;
+    // A failure worth retrying; see transientSqlstate().
+    bool transient() const { return !ok() && transientSqlstate(sqlstate()); }
+    // A failure that counts against the database's circuit breaker; see unavailableSqlstate().
+    bool unavailable() const { return !ok() && unavailableSqlstate(sqlstate()); }
+    PGresult* get() const { return res_; }
+    // Gives up ownership, for callers that still speak raw libpq.
+    PGresult* release() { return std::exchange(res_, nullptr); }
+    explicit operator bool() const { return res_ != nullptr; }
+
+    int rows() const { return PQntuples(res_); }
+    int columns() const { return PQnfields(res_); }
+    // Index of the named column, or -1.
+    int column(std::string_view name) const;
+
+    CellView value(int row, int column) const { return ResultView(res_).cell(row, column); }
+    bool isNull(int row, int column) const { return PQgetisnull(res_, row, column) != 0; }
+
+    // Parses the value as T (an integer, floating-point, bool or string type);
+    // NULL or an unparsable value gives fallback.
+    template <typename T>
+    T get(int row, int column, T fallback = T{}) const;
+    template <typename T>
+    T get(int row, std::string_view name, T fallback = T{}) const
+    {
+        const int c = column(name);
+        return c < 0 ? fallback : get<T>(row, c, std::move(fallback));
+    }
+
+private:
+    PGresult* res_;
+    mutable std::vector<std::pair<std::string, int>> names_;
+};
+
+template <typename T>
+T Result::get(int row, int column, T fallback) const
+{
+    const CellView cell = value(row, column);
+    if (SyncLayer::DB::isNull(cell)) return fallback;
+    if constexpr (std::is_same_v<T, bool>) {
+        return cell == "t" || cell == "true";
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        T parsed {};
+        auto [end, ec] = std::from_chars(cell.data(), cell.data() + cell.size(), parsed);
+        return ec == std::errc() && end == cell.data() + cell.size() ? parsed : fallback;
+    } else {
+        return T(cell);
+    }
+}
+
+} // namespace SyncLayer::DB
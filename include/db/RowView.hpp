@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string_view>
+
+#include <libpq-fe.h>
+
+namespace SyncLayer::DB {
+
+// A column value in text format that points into memory owned elsewhere (a
+// PGresult, a batch arena). A null data() pointer means SQL NULL, which is
+// distinct from the empty string.
+using CellView = std::string_view;
+
+inline bool isNull(CellView cell) { return cell.data() == nullptr; }
+
+/**
+ * @brief Cell views straight over a PGresult's tuple storage.
+ *
+ * Nothing is copied; the views stay valid until the result is cleared.
+ */
+class ResultView {
+public:
+    explicit ResultView(const PGresult* res) : res_(res) {}
+
+    int rows() const { return PQntuples(res_); }
+    int columns() const { return PQnfields(res_); }
+
+    CellView cell(int row, int column) const
+    {
+        if (PQgetisnull(res_, row, column)) return {};
+        return CellView(PQgetvalue(res_, row, column), static_cast<size_t>(PQgetlength(res_, row, column)));
+    }
+
+private:
+    const PGresult* res_;
+};
+
+} // namespace SyncLayer::DB
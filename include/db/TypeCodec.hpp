@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include <libpq-fe.h>
+
+namespace SyncLayer::DB {
+
+// Built-in type OIDs (see pg_type.dat); stable across servers.
+namespace TypeOid {
+constexpr Oid Bool = 16;
+constexpr Oid Int8 = 20;
+constexpr Oid Int2 = 21;
+constexpr Oid Int4 = 23;
+constexpr Oid Float4 = 700;
+constexpr Oid Float8 = 701;
+constexpr Oid Timestamp = 1114;
+constexpr Oid TimestampTz = 1184;
+constexpr Oid Numeric = 1700;
+constexpr Oid Uuid = 2950;
+}
+
+/**
+ * @brief Text-to-binary parameter encoders keyed by column type OID.
+ *
+ * Each encoder takes a value in PostgreSQL's text output format and appends
+ * its binary wire representation to `out`. It returns false (leaving `out`
+ * untouched) when it cannot represent the value, in which case the caller
+ * sends that value as text.
+ */
+class TypeCodec {
+public:
+    using Encoder = bool (*)(const char* text, size_t len, std::string& out);
+
+    // Encoder for a column type, or nullptr if the type is always sent as text.
+    static Encoder encoderFor(Oid type);
+
+    static bool encodeBool(const char* text, size_t len, std::string& out);
+    static bool encodeInt2(const char* text, size_t len, std::string& out);
+    static bool encodeInt4(const char* text, size_t len, std::string& out);
+    static bool encodeInt8(const char* text, size_t len, std::string& out);
+    static bool encodeFloat4(const char* text, size_t len, std::string& out);
+    static bool encodeFloat8(const char* text, size_t len, std::string& out);
+    // Expects DateStyle ISO output; BC dates fall back to text.
+    static bool encodeTimestamp(const char* text, size_t len, std::string& out);
+    static bool encodeTimestampTz(const char* text, size_t len, std::string& out);
+    static bool encodeUuid(const char* text, size_t len, std::string& out);
+    static bool encodeNumeric(const char* text, size_t len, std::string& out);
+};
+
+} // namespace SyncLayer::DB
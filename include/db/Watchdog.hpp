@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace SyncLayer::DB {
+
+class DBConnection;
+
+/**
+ * @brief Client-side deadlines for blocking database calls.
+ *
+ * arm() returns a guard; if the guard is still alive when its timeout
+ * passes, the watchdog thread runs its callback once. The usual callback
+ * is cancelOnTimeout()'s PQcancel, which makes whatever the connection is
+ * blocked in fail with "canceling statement due to user request"
+ * (SQLSTATE 57014). That covers waits statement_timeout can't see, such
+ * as a stalled network or a server that stopped answering.
+ *
+ * Each callback runs on a thread of its own, without the watchdog's lock:
+ * PQcancel opens a connection of its own, which can hang on the very
+ * network stall it is meant to break, and neither arm()/disarm() nor the
+ * deadlines of other connections may wait for that. An entry is only
+ * fired while still armed, and disarming one whose callback is under way
+ * waits for the callback to return. So a guard that has been destroyed
+ * never fires afterwards, and a late cancel can't hit the connection's
+ * next statement. Only the connection being canceled waits on its cancel.
+ */
+class Watchdog {
+public:
+    class Guard {
+    public:
+        Guard() = default;
+        ~Guard();
+        Guard(Guard&& other) noexcept;
+        Guard& operator=(Guard&& other) noexcept;
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+        // Whether the deadline passed while armed.
+        bool fired() const;
+        void disarm();
+
+    private:
+        friend class Watchdog;
+        Guard(Watchdog* owner, std::uint64_t id) : owner_(owner), id_(id) {}
+
+        Watchdog* owner_ {nullptr};
+        std::uint64_t id_ {0};
+        mutable bool fired_ {false};
+    };
+
+    Watchdog();
+    ~Watchdog();
+
+    Watchdog(const Watchdog&) = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+    // A non-positive timeout arms nothing.
+    Guard arm(std::chrono::milliseconds timeout, std::function<void()> onExpiry);
+    // Cancels the statement running on conn if the guard outlives timeout.
+    Guard cancelOnTimeout(DBConnection* conn, std::chrono::milliseconds timeout);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    enum class State { Armed, Firing, Fired };
+
+    struct Entry {
+        Clock::time_point deadline;
+        std::function<void()> onExpiry;
+        State state {State::Armed};
+        std::thread firing {}; // runs onExpiry; joined by release() or the destructor
+    };
+
+    // Removes the entry once its callback, if running, has returned; returns whether it had fired.
+    bool release(std::uint64_t id);
+    bool hasFired(std::uint64_t id);
+    void run();
+    void fire(std::uint64_t id, const std::function<void()>& onExpiry);
+
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::condition_variable settled_; // a callback returned
+    std::map<std::uint64_t, Entry> armed_;
+    std::uint64_t nextId_ {1};
+    bool stopping_ {false};
+    std::thread thread_;
+};
+
+} // namespace SyncLayer::DB
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "../db/ConnectionPool.hpp"
+#include "../db/Watchdog.hpp"
+#include "../tracker/ChangeEvent.hpp"
+#include "ColumnBatch.hpp"
+
+namespace SyncLayer {
+namespace DB { class DBConnection; }
+namespace Tracker { class TableTracker; }
+}
+
+namespace SyncLayer::Queue {
+
+/**
+ * @brief Writes change events to a target connection as primary-key upserts and deletes.
+ *
+ * Every apply transaction also advances the pipeline's progress row for the
+ * calling slot to `upTo`, the source position the transaction covers. With
+ * a watchdog, each transaction is canceled once it runs past `timeout`. With
+ * the target's circuit breaker, failures that lose the connection count
+ * against it (contention doesn't), and while it is open transactions are
+ * refused as kTransient without a round trip.
+ */
+class EventApplier {
+public:
+    // applyTransaction()'s result when the transaction was rolled back for running too long
+    static constexpr int kTimedOut = -2;
+    // ...or for an error that may clear up by itself (see DB::transientSqlstate)
+    static constexpr int kTransient = -3;
+
+    EventApplier(const SyncLayer::Tracker::TableTracker* tracker, std::string pipeline,
+                 SyncLayer::DB::Watchdog* watchdog = nullptr, std::chrono::milliseconds timeout = {},
+                 SyncLayer::Utils::CircuitBreaker* breaker = nullptr);
+
+    // Rebuilds the per-table upsert statements; call after tables are rediscovered.
+    void refresh();
+
+    // Applies the events in order inside one transaction; returns how many were
+    // applied. A batch that times out is split in half and each half retried.
+    // One that fails transiently is copied to deferred, when given, for the
+    // caller to retry later. Any other failure falls back to one event at a time.
+    int apply(SyncLayer::DB::DBConnection* target, const std::vector<SyncLayer::Tracker::ChangeEvent>& events,
+              int slot, std::uint64_t upTo, std::vector<SyncLayer::Tracker::ChangeEvent>* deferred = nullptr) const;
+    // All-or-nothing variant; returns -1 (or kTimedOut, kTransient) when the transaction was rolled back.
+    int applyTransaction(SyncLayer::DB::DBConnection* target, const std::vector<SyncLayer::Tracker::ChangeEvent>& events,
+                         int slot, std::uint64_t upTo) const;
+
+    // Events given up on after failing on their own (progress moved past them); each one is logged.
+    std::uint64_t skipped() const { return skipped_.load(std::memory_order_relaxed); }
+    void countSkipped(std::uint64_t n) const { skipped_.fetch_add(n, std::memory_order_relaxed); }
+
+private:
+    enum class Outcome { Applied, Failed, TimedOut, Transient };
+
+    // applyTransaction() past the breaker.
+    int attempt(SyncLayer::DB::DBConnection* target, const std::vector<SyncLayer::Tracker::ChangeEvent>& events,
+                int slot, std::uint64_t upTo) const;
+    bool applicable(const SyncLayer::Tracker::ChangeEvent& event) const;
+    Outcome applyOne(SyncLayer::DB::DBConnection* target, const SyncLayer::Tracker::ChangeEvent& event) const;
+    // Applies events in order, one bulk upsert per run of same-table changes where the rows allow;
+    // returns -1 (or kTimedOut, kTransient) on the first failure.
+    int applyEvents(SyncLayer::DB::DBConnection* target, const std::vector<SyncLayer::Tracker::ChangeEvent>& events) const;
+    Outcome applyColumns(SyncLayer::DB::DBConnection* target, ColumnBatch& batch) const;
+    Outcome deleteColumns(SyncLayer::DB::DBConnection* target, ColumnBatch& batch) const;
+    std::string upsertSql(const std::string& table) const;
+
+    struct Statement {
+        std::string sql; // empty when the table has no primary key
+        std::string deleteSql; // by primary key, one row
+        std::string bulkDeleteSql; // by primary key, one array parameter per key column
+        std::vector<size_t> keys; // positions of the primary-key columns
+        size_t columns {0};
+    };
+
+    const SyncLayer::Tracker::TableTracker* tracker_;
+    std::string pipeline_;
+    SyncLayer::DB::Watchdog* watchdog_;
+    std::chrono::milliseconds timeout_;
+    SyncLayer::Utils::CircuitBreaker* breaker_;
+    std::unordered_map<SyncLayer::Tracker::TableId, Statement> statements_;
+    mutable std::atomic<std::uint64_t> skipped_ {0};
+};
+
+/**
+ * @brief Background apply thread on its own leased hosted connection.
+ *
+ * Tasks submitted to a worker run in submission order, so routing every
+ * change of a given key to the same worker keeps that key ordered.
+ */
+class ApplyWorker {
+public:
+    // A unit of apply work; returns the number of events it applied.
+    using Task = std::function<int(SyncLayer::DB::DBConnection*)>;
+
+    ApplyWorker(int id, SyncLayer::DB::ConnectionPool::Lease conn);
+    ~ApplyWorker();
+
+    ApplyWorker(const ApplyWorker&) = delete;
+    ApplyWorker& operator=(const ApplyWorker&) = delete;
+
+    void submit(Task task);
+    // Blocks until everything submitted so far has run; returns the applied count.
+    int waitIdle();
+
+private:
+    void run();
+    int id_;
+    SyncLayer::DB::ConnectionPool::Lease conn_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<Task> pending_;
+    bool busy_ {false};
+    bool stopping_ {false};
+    int applied_ {0};
+    std::thread thread_;
+};
+
+} // namespace SyncLayer::Queue
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <libpq-fe.h>
+#include "../tracker/ChangeEvent.hpp"
+
+namespace SyncLayer::Queue {
+
+/**
+ * @brief Same-table change events stored column by column.
+ *
+ * Columns whose type has a fixed-width binary encoding (integers, floats,
+ * bool, timestamps, uuid) hold their values contiguously in network byte
+ * order; everything else is kept as views of the text values in the
+ * events' payloads, so the events must outlive the batch. Each column has
+ * a validity bitmap (bit set = not NULL), Arrow-style. The layout maps
+ * one-to-one onto the array parameters of a BulkUpsert.
+ */
+class ColumnBatch {
+public:
+    struct Column {
+        Oid type {0};
+        size_t width {0}; // bytes per value, 0 for variable-length text
+        std::string data; // fixed-width values, width bytes per row
+        std::vector<std::string_view> text; // variable-length values
+        std::vector<std::uint64_t> valid;
+
+        bool isValid(size_t row) const { return (valid[row >> 6] >> (row & 63)) & 1; }
+    };
+
+    ColumnBatch(SyncLayer::Tracker::TableId table, const std::vector<Oid>& types);
+
+    // Transposes the event's row image into the columns. Returns false, leaving
+    // the batch unchanged, if it doesn't match the column layout.
+    bool append(const SyncLayer::Tracker::ChangeEvent& event);
+    // Keeps only the last row for each primary key, in arrival order, so a
+    // single upsert statement never touches one row twice.
+    void coalesce();
+
+    SyncLayer::Tracker::TableId table() const { return table_; }
+    size_t rows() const { return keyHashes_.size(); }
+    size_t columns() const { return columns_.size(); }
+    const Column& column(size_t j) const { return columns_[j]; }
+
+    // Writes column j as an array parameter; returns its format (1 = array_send binary, 0 = text literal).
+    int writeArray(size_t j, std::string& out) const;
+
+private:
+    void truncate(size_t rows);
+    void gather(const std::vector<std::uint32_t>& keep);
+
+    SyncLayer::Tracker::TableId table_;
+    std::vector<Column> columns_;
+    std::vector<std::size_t> keyHashes_;
+    std::vector<std::string_view> keys_;
+    std::vector<const char*> values_; // scratch for unpacking payloads
+    std::vector<int> lengths_;
+};
+
+// Splits events into maximal runs of consecutive changes to one table, in
+// order, with deletes and upserts in separate runs. Each run can go out as
+// one statement; merging beyond a run would reorder statements across tables
+// and break foreign keys between them, or resurrect a row deleted after an upsert.
+std::vector<std::vector<const SyncLayer::Tracker::ChangeEvent*>>
+statementRuns(const std::vector<const SyncLayer::Tracker::ChangeEvent*>& events);
+
+} // namespace SyncLayer::Queue
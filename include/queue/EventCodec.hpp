@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "../tracker/ChangeEvent.hpp"
+
+namespace SyncLayer::Queue {
+
+/**
+ * @brief Binary serialization of ChangeEvent for on-disk queues.
+ *
+ * Strings are u32 length-prefixed, integers little-endian; the layout is
+ * private to this process's queue files and not a wire format.
+ */
+class EventCodec {
+public:
+    static void encode(const SyncLayer::Tracker::ChangeEvent& event, std::string& out);
+    // Copies key and payload into arena, which the event then shares.
+    static bool decode(const char* data, size_t len, SyncLayer::Tracker::ChangeEvent& event,
+                       const std::shared_ptr<SyncLayer::Utils::Arena>& arena);
+    // Reads only the source position, without materializing the event.
+    static bool decodeLsn(const char* data, size_t len, std::uint64_t& lsn);
+};
+
+} // namespace SyncLayer::Queue
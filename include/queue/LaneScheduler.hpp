@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../config/Config.hpp"
+#include "../tracker/ChangeEvent.hpp"
+#include "../utils/TimerWheel.hpp"
+
+namespace SyncLayer::Queue {
+
+/**
+ * @brief Per-table apply lanes, so a bulk load on one table can't hold back the others.
+ *
+ * Each table's events wait in their own FIFO lane. A round first serves
+ * lanes with a lag objective in earliest-deadline order (deadline = arrival
+ * of the lane's oldest event + max_lag_ms), using at most half the round,
+ * then fills the rest by deficit round-robin in proportion to lane weights.
+ * Order within a table is kept; order across tables is not.
+ *
+ * Events that failed to apply with a transient error are handed back with
+ * defer(). They return to the head of their lanes, and those lanes are
+ * parked on a timer wheel for a jittered, growing backoff. Meanwhile every
+ * other lane is served as usual, and the parked table's own later events
+ * wait behind the failed ones, so nothing overtakes them.
+ *
+ * Apply reads the queue ahead into the lanes and takes each micro-batch
+ * as one round, so a table's backlog only delays the others by the share
+ * of a round it is given.
+ */
+class LaneScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // A round stops short of maxRoundBytes, but always takes at least one event.
+    explicit LaneScheduler(const std::map<std::string, SyncLayer::Config::LaneSettings>& lanes,
+                           size_t maxRoundBytes = SIZE_MAX);
+
+    void push(SyncLayer::Tracker::ChangeEvent&& event, Clock::time_point arrived);
+    // Moves up to max events from lanes that aren't parked into out; returns how many.
+    size_t next(std::vector<SyncLayer::Tracker::ChangeEvent>& out, size_t max, Clock::time_point now = Clock::now());
+    // Returns events from the last round that should be retried later; call before the next round.
+    // Lanes of that round with nothing deferred count as healthy again.
+    void defer(std::vector<SyncLayer::Tracker::ChangeEvent>&& events, Clock::time_point now = Clock::now());
+    bool empty() const { return size_ == 0; }
+    // Includes events in parked lanes.
+    size_t size() const { return size_; }
+    size_t parked() const { return parked_; }
+    // Footprint of every waiting event, parked or not.
+    size_t bytes() const { return bytes_; }
+    // When the earliest parked lane comes due; max() if none.
+    Clock::time_point nextRetry() const { return retries_.nextDue(); }
+    // Smallest source position still waiting in any lane, or 0 if none.
+    std::uint64_t minPendingLsn() const;
+
+private:
+    // Events a lane of weight 1 may take per round-robin turn
+    static constexpr size_t kQuantum = 16;
+
+    struct Pending {
+        SyncLayer::Tracker::ChangeEvent event;
+        Clock::time_point arrived;
+    };
+
+    struct Lane {
+        size_t weight {1};
+        std::chrono::milliseconds maxLag {0};
+        std::deque<Pending> events;
+        size_t deficit {0};
+        bool parked {false};
+        bool inFlight {false}; // served in the last round
+        std::chrono::milliseconds backoff {0}; // last retry delay; 0 while healthy
+    };
+
+    Lane& laneFor(SyncLayer::Tracker::TableId table);
+    // Takes up to n events from the lane's head while they fit in roundLeft bytes.
+    size_t take(Lane& lane, size_t n, std::vector<SyncLayer::Tracker::ChangeEvent>& out, size_t& roundLeft);
+    // Unparks lanes whose retry is due and settles the last round's lanes.
+    void wake(Clock::time_point now);
+
+    std::unordered_map<SyncLayer::Tracker::TableId, SyncLayer::Config::LaneSettings> settings_;
+    std::vector<Lane> lanes_;
+    std::unordered_map<SyncLayer::Tracker::TableId, size_t> index_;
+    size_t cursor_ {0};
+    size_t size_ {0};
+    size_t parked_ {0};
+    size_t bytes_ {0};
+    const size_t maxRoundBytes_;
+    SyncLayer::Utils::TimerWheel<size_t> retries_ {std::chrono::milliseconds(10)}; // lane indexes
+};
+
+} // namespace SyncLayer::Queue
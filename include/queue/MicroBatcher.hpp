@@ -0,0 +1,48 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+#include "../tracker/ChangeEvent.hpp"
+
+namespace SyncLayer::Queue {
+
+/**
+ * @brief Cuts the apply stream into micro-batches of at most N events or B bytes.
+ *
+ * Capture reads in fixed fetch-sized chunks; apply wants batches sized for
+ * the target instead: large under a burst, but small enough that one
+ * transaction stays bounded. Events are added in queue order and a batch is
+ * handed out as soon as it reaches either limit. When source transactions
+ * must stay whole, a full batch is only cut where the transaction id
+ * changes, so it may run over the limits by the rest of that transaction.
+ * The latency trigger (T ms since the oldest queued event) applies to the
+ * queue as a whole and is checked through due().
+ */
+class MicroBatcher {
+public:
+    MicroBatcher(size_t maxEvents, size_t maxBytes, std::chrono::milliseconds maxWait, bool keepTransactions);
+
+    // Adds one event; when that completes a batch, moves it into out and returns true.
+    bool add(SyncLayer::Tracker::ChangeEvent&& event, std::vector<SyncLayer::Tracker::ChangeEvent>& out);
+    // Moves the open batch, however small, into out; returns false if it was empty.
+    bool flush(std::vector<SyncLayer::Tracker::ChangeEvent>& out);
+    bool empty() const { return open_.empty(); }
+
+    // Whether a queue holding this much, with its oldest event this old, should be applied now.
+    bool due(size_t events, size_t bytes, std::chrono::milliseconds oldest) const;
+
+    size_t maxEvents() const { return maxEvents_; }
+
+private:
+    bool full() const { return open_.size() >= maxEvents_ || openBytes_ >= maxBytes_; }
+
+    const size_t maxEvents_;
+    const size_t maxBytes_;
+    const std::chrono::milliseconds maxWait_;
+    const bool keepTransactions_;
+    std::vector<SyncLayer::Tracker::ChangeEvent> open_;
+    size_t openBytes_ {0};
+};
+
+} // namespace SyncLayer::Queue
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace SyncLayer {
+namespace DB { class DBConnection; }
+}
+
+namespace SyncLayer::Queue {
+
+/**
+ * @brief Apply progress stored on the hosted target in `synclayer_progress`.
+ *
+ * One row per (pipeline, slot), where a slot is an apply worker. Each row is
+ * updated inside the same transaction as the changes it covers, so after a
+ * crash the row says exactly what the target already has.
+ */
+class ProgressTable {
+public:
+    static bool ensure(SyncLayer::DB::DBConnection* target);
+    // Last applied source position per slot; empty when the pipeline has never applied anything.
+    static std::map<int, std::uint64_t> load(SyncLayer::DB::DBConnection* target, const std::string& pipeline);
+    // Advances the slot to lsn (never backwards); meant to run inside the apply transaction.
+    static bool record(SyncLayer::DB::DBConnection* target, const std::string& pipeline, int slot, std::uint64_t lsn);
+};
+
+} // namespace SyncLayer::Queue
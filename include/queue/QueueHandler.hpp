@@ -1,21 +1,121 @@
 #pragma once
 
-#include <queue>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include "../tracker/ChangeEvent.hpp"
+#include "ApplyWorker.hpp"
+#include "RingBuffer.hpp"
+#include "SegmentLog.hpp"
+#include "SpillStore.hpp"
+#include "LaneScheduler.hpp"
+#include "MicroBatcher.hpp"
+#include "../utils/TimerWheel.hpp"
 
 namespace SyncLayer {
-namespace DB { class DBConnection; }
+namespace Config { class Config; }
+namespace DB { class DBConnection; class ConnectionPool; }
+namespace Tracker { class TableTracker; }
 }
 
 namespace SyncLayer::Queue {
 
 class QueueHandler {
 public:
-    void enqueue(const SyncLayer::Tracker::ChangeEvent& event);
+    // Apply workers lease their connections from hosted.
+    QueueHandler(std::shared_ptr<SyncLayer::Config::Config> config,
+                 const SyncLayer::Tracker::TableTracker* tracker, SyncLayer::DB::ConnectionPool& hosted);
+    // Takes ownership of the batch and returns the events that did not fit (the
+    // queue is full or over its memory budget and can't spill); the caller
+    // should drain, then offer those again.
+    std::vector<SyncLayer::Tracker::ChangeEvent> enqueueBatch(std::vector<SyncLayer::Tracker::ChangeEvent>&& batch);
+    bool overBudget() const;
+    size_t queuedBytes() const;
+    // Age of the oldest event still waiting for apply.
+    std::chrono::milliseconds applyLag() const;
+    // Events that failed on their own and were given up on, since start.
+    std::uint64_t skippedEvents() const { return applier_.skipped(); }
+    // True once queued events reach apply_batch_size or apply_batch_mb, or
+    // the oldest has waited apply_max_wait_ms: time to drain.
+    bool flushDue() const;
+    // Reads this pipeline's progress rows from the target; returns the source
+    // position capture should resume after (0 if nothing was ever applied).
+    std::uint64_t loadProgress(SyncLayer::DB::DBConnection* target);
+    // Applies queued events to target, or across the apply workers when more than one is configured.
     void drainTo(SyncLayer::DB::DBConnection* target);
+    // Whether events are parked in a lane or held for a retry.
+    bool holding() const;
+    // When the earliest parked lane or held transaction comes due; max() if none.
+    std::chrono::steady_clock::time_point nextRetry() const;
 
 private:
-    std::queue<SyncLayer::Tracker::ChangeEvent> q_;
+    // Fills its argument with the next events to drain; returns how many, 0 once empty.
+    using Source = std::function<size_t(std::vector<SyncLayer::Tracker::ChangeEvent>&)>;
+
+    // Applies one batch and returns how many events were applied. Recorded
+    // progress is capped at maxUpTo while older events still wait in a lane.
+    // With deferred set, events that failed transiently go there to be retried
+    // later instead of row by row, and stay counted against the memory budget.
+    // In transaction mode the first `held` events are transactions whose retry
+    // isn't due yet: they, and what depends on them, go to deferred untried.
+    int applyBatch(SyncLayer::DB::DBConnection* target, std::vector<SyncLayer::Tracker::ChangeEvent> batch,
+                   std::uint64_t maxUpTo = UINT64_MAX,
+                   std::vector<SyncLayer::Tracker::ChangeEvent>* deferred = nullptr, size_t held = 0);
+    // Hash mode: applies what waits in the lanes, one round per micro-batch, until
+    // only parked lanes are left. They stay behind until a later call finds their retry due.
+    int applyLanes(SyncLayer::DB::DBConnection* target);
+    // Transaction mode: applies the batch behind any held-back transactions and
+    // holds back, whole and in commit order, those that time out or fail transiently.
+    int applyHeld(SyncLayer::DB::DBConnection* target, std::vector<SyncLayer::Tracker::ChangeEvent> batch);
+    // Cuts everything source yields into micro-batches and applies them. checkpoint,
+    // if set, runs whenever every event read so far has been applied.
+    int drainFrom(SyncLayer::DB::DBConnection* target, const Source& source, size_t& queued,
+                  const std::function<void()>& checkpoint);
+    // drainFrom in hash mode: reads source ahead into the lanes, up to the memory
+    // budget, and lets their rounds decide what each micro-batch holds.
+    int drainLanes(SyncLayer::DB::DBConnection* target, const Source& source, size_t& queued,
+                   const std::function<void()>& checkpoint);
+    void release(size_t bytes, size_t events);
+    void markEnqueued(size_t bytes, size_t events);
+    // Moves batch[from..] into the spill until its disk budget runs out; returns how many it took.
+    size_t spill(std::vector<SyncLayer::Tracker::ChangeEvent>& batch, size_t from);
+    size_t shardFor(const SyncLayer::Tracker::ChangeEvent& event) const;
+    int applySharded(std::vector<SyncLayer::Tracker::ChangeEvent> batch, std::uint64_t upTo,
+                     std::vector<SyncLayer::Tracker::ChangeEvent>* deferred);
+    int applyTransactions(SyncLayer::DB::DBConnection* target, std::vector<SyncLayer::Tracker::ChangeEvent> batch,
+                          std::uint64_t upTo, std::vector<SyncLayer::Tracker::ChangeEvent>* deferred, size_t held);
+    std::shared_ptr<SyncLayer::Config::Config> config_;
+    bool transactional_;
+    std::unique_ptr<SyncLayer::DB::Watchdog> watchdog_; // set when apply_timeout_ms > 0
+    EventApplier applier_;
+    std::vector<std::unique_ptr<ApplyWorker>> workers_;
+    std::vector<std::uint64_t> appliedLsn_; // per slot, as last recorded on the target
+    RingBuffer<SyncLayer::Tracker::ChangeEvent> q_;
+    std::unique_ptr<SegmentLog> log_; // set when queue_backend is "disk"; replaces q_
+    // Overflow past the memory budget, when spill_max_mb > 0. While spilling,
+    // every new event goes to overflow_ so nothing overtakes the spilled ones.
+    std::unique_ptr<SpillStore> spill_;
+    std::mutex spillMutex_;
+    std::atomic<bool> spilling_ {false};
+    std::atomic<bool> spillFull_ {false};
+    std::vector<SyncLayer::Tracker::ChangeEvent> overflow_;
+    size_t overflowBytes_ {0};
+    std::unique_ptr<LaneScheduler> lanes_; // hash mode only
+    // Transaction mode: source transactions held back after a timeout or transient
+    // failure, with those that depend on them, in commit order until heldRetry_ fires
+    std::vector<SyncLayer::Tracker::ChangeEvent> held_;
+    SyncLayer::Utils::TimerWheel<bool> heldRetry_ {std::chrono::milliseconds(10)};
+    std::chrono::milliseconds heldBackoff_ {0};
+    bool heldDue_ {false};
+    const size_t memoryBudget_;
+    MicroBatcher batcher_;
+    std::atomic<size_t> bytes_ {0};
+    std::atomic<size_t> events_ {0};
+    std::atomic<std::chrono::steady_clock::rep> oldestEnqueuedAt_ {0};
 };
 
-}
\ No newline at end of file
+}
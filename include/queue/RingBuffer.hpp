@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace SyncLayer::Queue {
+
+/**
+ * @brief Bounded lock-free multi-producer / single-consumer ring buffer.
+ *
+ * Producers claim a contiguous range of slots with one CAS on the head
+ * index, fill them, and publish each slot through its sequence number. The
+ * single consumer reads published slots in order and advances the tail.
+ * Head and tail live on separate cache lines so producers and the consumer
+ * don't false-share.
+ */
+template <typename T>
+class RingBuffer {
+public:
+    // Capacity is rounded up to a power of two.
+    explicit RingBuffer(size_t capacity)
+    {
+        size_t cap = 1;
+        while (cap < capacity) cap <<= 1;
+        mask_ = cap - 1;
+        slots_ = std::make_unique<Slot[]>(cap);
+    }
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    bool tryPush(T&& value)
+    {
+        return tryPushBatch(&value, 1) == 1;
+    }
+
+    // Moves up to n items in; returns how many fit. Any producer thread.
+    size_t tryPushBatch(T* items, size_t n)
+    {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        size_t count;
+        while (true) {
+            // Slots below the tail have been moved out, so [pos, tail + capacity) is writable
+            const size_t used = pos - tail_.load(std::memory_order_acquire);
+            if (used > capacity()) {
+                pos = head_.load(std::memory_order_relaxed); // pos went stale
+                continue;
+            }
+            count = n < capacity() - used ? n : capacity() - used;
+            if (count == 0) return 0;
+            if (head_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) break;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            Slot& slot = slots_[(pos + i) & mask_];
+            slot.value = std::move(items[i]);
+            slot.seq.store(pos + i + 1, std::memory_order_release);
+        }
+        return count;
+    }
+
+    bool tryPop(T& out)
+    {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        Slot& slot = slots_[tail & mask_];
+        if (slot.seq.load(std::memory_order_acquire) != tail + 1) return false;
+        out = std::move(slot.value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Appends up to max published items to out; returns how many. Consumer thread only.
+    size_t tryPopBatch(std::vector<T>& out, size_t max)
+    {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t n = 0;
+        while (n < max) {
+            Slot& slot = slots_[tail & mask_];
+            if (slot.seq.load(std::memory_order_acquire) != tail + 1) break;
+            out.push_back(std::move(slot.value));
+            ++tail;
+            ++n;
+        }
+        if (n > 0) tail_.store(tail, std::memory_order_release);
+        return n;
+    }
+
+    // Claimed but not yet consumed; may include slots still being filled.
+    size_t sizeApprox() const
+    {
+        return head_.load(std::memory_order_relaxed) - tail_.load(std::memory_order_relaxed);
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    static constexpr size_t kCacheLine = 64;
+
+    struct Slot {
+        std::atomic<size_t> seq {0};
+        T value {};
+    };
+
+    alignas(kCacheLine) std::atomic<size_t> head_ {0};
+    alignas(kCacheLine) std::atomic<size_t> tail_ {0};
+    alignas(kCacheLine) size_t mask_ {0};
+    std::unique_ptr<Slot[]> slots_;
+};
+
+} // namespace SyncLayer::Queue
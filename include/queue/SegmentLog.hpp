@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "../tracker/ChangeEvent.hpp"
+
+namespace SyncLayer::Queue {
+
+/**
+ * @brief Durable change queue made of fixed-size mmap'd segment files.
+ *
+ * Records are appended as [u32 length][u32 crc][u64 segment][payload]. The
+ * segment number in each header lets a consumed file be recycled without
+ * zeroing it: leftover records from its previous use carry an older number
+ * and read as end-of-data, as do torn writes (bad CRC). The apply side
+ * reads ahead from an in-memory position and only persists it to the
+ * `cursor` file once the batch has committed on the target, so a restart
+ * replays at most the last uncommitted batch.
+ */
+class SegmentLog {
+public:
+    SegmentLog(const std::string& dir, size_t segmentBytes);
+    ~SegmentLog();
+
+    SegmentLog(const SegmentLog&) = delete;
+    SegmentLog& operator=(const SegmentLog&) = delete;
+
+    void append(const SyncLayer::Tracker::ChangeEvent& event);
+    void append(const std::vector<SyncLayer::Tracker::ChangeEvent>& batch);
+    // Flushes appended records to disk.
+    void sync();
+    // Reads up to max events past the read position; returns how many.
+    size_t readBatch(std::vector<SyncLayer::Tracker::ChangeEvent>& out, size_t max);
+    // Persists the read position and recycles segments that are fully consumed.
+    void commit();
+    // Drops everything not yet read, as if it had been applied, and persists that.
+    void discard();
+    // Source position of the newest event in the log, including ones from before a restart.
+    std::uint64_t lastLsn() const;
+
+private:
+    struct Segment {
+        std::uint64_t seq {0};
+        int fd {-1};
+        char* data {nullptr};
+    };
+
+    std::string pathFor(std::uint64_t seq) const;
+    Segment map(std::uint64_t seq, bool create) const;
+    void unmap(Segment& seg) const;
+    // Payload length of a valid record at offset, or 0 at the end of the segment's data
+    size_t recordAt(const Segment& seg, size_t offset, const char*& payload) const;
+    void appendLocked(const SyncLayer::Tracker::ChangeEvent& event);
+    void roll();
+    void recycle(std::uint64_t seq);
+    void saveCursor() const;
+
+    std::string dir_;
+    size_t segmentBytes_;
+    mutable std::mutex mutex_;
+    Segment write_;
+    size_t writeOffset_ {0};
+    size_t syncedOffset_ {0};
+    Segment read_;
+    size_t readOffset_ {0};
+    std::uint64_t committedSeq_ {0};
+    std::vector<std::string> spares_;
+    std::uint64_t lastLsn_ {0};
+    std::string scratch_;
+};
+
+} // namespace SyncLayer::Queue
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+#include "../tracker/ChangeEvent.hpp"
+
+namespace SyncLayer::Queue {
+
+/**
+ * @brief Local files holding change batches that overflowed the in-memory queue.
+ *
+ * Each write() stores one batch as a single compressed block (zstd when the
+ * build has it, raw otherwise) and batches are read back oldest first. The
+ * files only buffer this process's queue: capture resumes from the target's
+ * progress after a restart, so leftovers are deleted on open.
+ */
+class SpillStore {
+public:
+    SpillStore(const std::string& dir, size_t maxBytes);
+    ~SpillStore();
+
+    SpillStore(const SpillStore&) = delete;
+    SpillStore& operator=(const SpillStore&) = delete;
+
+    // Returns false, writing nothing, when the batch would exceed the disk budget.
+    bool write(const std::vector<SyncLayer::Tracker::ChangeEvent>& batch);
+    // Appends the oldest spilled batch to out and deletes its file; false when none is left.
+    bool readNext(std::vector<SyncLayer::Tracker::ChangeEvent>& out);
+    bool empty() const;
+    size_t diskBytes() const;
+
+private:
+    struct File {
+        std::string path;
+        size_t bytes {0};
+    };
+
+    std::string dir_;
+    size_t maxBytes_;
+    std::deque<File> files_;
+    size_t diskBytes_ {0};
+    std::uint64_t nextSeq_ {1};
+    std::string raw_;
+    std::string packed_;
+};
+
+} // namespace SyncLayer::Queue
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "../tracker/ChangeEvent.hpp"
+
+namespace SyncLayer::Queue {
+
+struct SourceTransaction {
+    std::uint64_t txId;
+    std::vector<SyncLayer::Tracker::ChangeEvent> events;
+    std::vector<size_t> dependsOn; // earlier transactions that wrote one of our keys
+};
+
+/**
+ * @brief Orders source transactions for parallel apply.
+ *
+ * Events are grouped into transactions by txId (in commit order). A
+ * transaction depends on the latest earlier transaction that wrote each
+ * (table, key) in its write set, so transactions with disjoint write sets
+ * may be applied concurrently while overlapping ones keep commit order.
+ * A transaction held back for a retry holds back its dependents as well.
+ */
+class TransactionScheduler {
+public:
+    explicit TransactionScheduler(std::vector<SyncLayer::Tracker::ChangeEvent> events);
+
+    size_t size() const;
+    const SourceTransaction& transaction(size_t index) const;
+
+    // Worker index for each transaction; a transaction whose dependencies all
+    // live on one worker is queued behind them there, so it never has to wait.
+    std::vector<size_t> assign(size_t nWorkers) const;
+
+    // Blocks until every dependency is done; false if one of them was held back.
+    bool waitForDependencies(size_t index);
+    void markDone(size_t index, bool heldBack = false);
+    // Source position of the oldest transaction other than index that isn't done
+    // yet; UINT64_MAX if none. Progress recorded below it covers every commit.
+    std::uint64_t oldestPendingLsn(size_t index);
+
+private:
+    std::vector<SourceTransaction> txns_;
+    std::vector<bool> done_;
+    std::vector<bool> heldBack_;
+    size_t firstPending_ {0}; // every transaction before it is done
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+} // namespace SyncLayer::Queue
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <db/DBConnection.hpp>
+#include <db/ConnectionPool.hpp>
+#include <db/Result.hpp>
 #include <tracker/TableTracker.hpp>
 #include <queue/QueueHandler.hpp>
 
@@ -22,6 +27,7 @@ struct HealthStatus {
     long hostedDbSizeMB;
     long localActiveQueries;
     long hostedActiveQueries;
+    std::uint64_t skippedEvents; // changes apply gave up on; nonzero means the target has drifted
 };
 
 class ReplicationManager {
@@ -29,18 +35,33 @@ public:
     ReplicationManager(std::shared_ptr<SyncLayer::Config::Config> config,
                        std::shared_ptr<SyncLayer::Logging::Logger> logger);
     void start();
+    // Makes a running start() stop capturing and return after draining what it read; thread-safe.
+    void stop() { stopping_.store(true, std::memory_order_relaxed); }
     HealthStatus healthCheck();
 
 private:
     void initialSync();
-    PGresult* executeWithRetry(PGconn* conn, const std::string& query, int maxAttempts = 3);
+    // Reconnects a dropped connection (restoring its prepared statements) before each attempt.
+    // Only transient failures (see DB::transientSqlstate) are retried, and none while the
+    // database's breaker is open. The result of the last attempt is returned either way, so
+    // callers can report its error.
+    SyncLayer::DB::Result executePreparedWithRetry(SyncLayer::DB::DBConnection* db,
+                                                   SyncLayer::Utils::CircuitBreaker& breaker,
+                                                   const std::string& statement, int nParams,
+                                                   const char* const* values, const int* lengths,
+                                                   const int* formats, int maxAttempts = 3);
     std::shared_ptr<SyncLayer::Config::Config> config_;
     std::shared_ptr<SyncLayer::Logging::Logger> logger_;
-    std::unique_ptr<SyncLayer::DB::DBConnection> local_;
-    std::unique_ptr<SyncLayer::DB::DBConnection> hosted_;
+    std::unique_ptr<SyncLayer::DB::ConnectionPool> localPool_;
+    std::unique_ptr<SyncLayer::DB::ConnectionPool> hostedPool_;
+    // Held for the manager's lifetime: change capture reads through local_,
+    // and drains apply inline on hosted_
+    SyncLayer::DB::ConnectionPool::Lease local_;
+    SyncLayer::DB::ConnectionPool::Lease hosted_;
     std::unique_ptr<SyncLayer::Tracker::TableTracker> tracker_;
     std::unique_ptr<SyncLayer::Queue::QueueHandler> queue_;
     bool initialSyncDone_;
+    std::atomic<bool> stopping_ {false};
 };
 
 } // namespace SyncLayer::Replication
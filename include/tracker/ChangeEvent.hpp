@@ -1,17 +1,70 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
+#include "../utils/Arena.hpp"
 
 namespace SyncLayer {
 namespace Tracker {
 
+enum class Op : std::uint8_t { Insert, Update, Delete };
+
+const char* opName(Op op);
+
+using TableId = std::uint32_t;
+
+/**
+ * @brief Process-wide interning of table names.
+ *
+ * Events carry a TableId instead of the name; ids are assigned on first
+ * sight and never reused, so they are only meaningful within one process.
+ */
+class TableRegistry {
+public:
+    static TableId intern(std::string_view name);
+    static const std::string& name(TableId id);
+};
+
+/**
+ * @brief Row image packed into one buffer.
+ *
+ * Per column, in table column order: an i32 length (-1 for NULL), then the
+ * value in text format and a NUL, so values can be handed to libpq in place.
+ */
+class ColumnPayload {
+public:
+    // values[i] == nullptr marks a NULL column.
+    static std::string_view pack(SyncLayer::Utils::Arena& arena, const char* const* values, const int* lengths, int n);
+    // Appends pointers into payload (nullptr for NULL); false if it is malformed.
+    static bool unpack(std::string_view payload, std::vector<const char*>& values, std::vector<int>& lengths);
+};
+
 struct ChangeEvent {
-    std::string table;
-    std::string operation; // insert/update/delete
-    std::string payloadJson; // serialized row change
+    TableId table {0};
+    Op op {Op::Insert};
+    std::uint64_t txId {0}; // source transaction id, 0 when unknown
+    std::uint64_t lsn {0}; // source position of the change; apply records it as progress
+    std::string_view key; // primary-key values, used to route the event to an apply worker
+    std::string_view payload; // see ColumnPayload
+    std::shared_ptr<const SyncLayer::Utils::Arena> arena; // owns key and payload, shared by the batch
+
+    // Approximate memory held by this event, for queue budgeting
+    std::size_t footprint() const {
+        return sizeof(ChangeEvent) + key.size() + payload.size();
+    }
+
+    // Same for every change to one row
+    std::size_t rowHash() const {
+        std::size_t h = std::hash<TableId>{}(table);
+        return h ^ (std::hash<std::string_view>{}(key) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+    }
 };
 
 } // namespace Tracker
 } // namespace SyncLayer
 
-
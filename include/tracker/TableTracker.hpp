@@ -4,8 +4,11 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <cstdint>
 #include "ChangeEvent.hpp"
 
+#include <libpq-fe.h>
+
 namespace SyncLayer {
 namespace Config { class Config; }
 namespace DB { class DBConnection; }
@@ -20,14 +23,25 @@ public:
     TableTracker(SyncLayer::DB::DBConnection* local, std::shared_ptr<SyncLayer::Config::Config> config);
     void discoverTables();
     std::vector<ChangeEvent> fetchChanges(int batchSize);
+    // Continue capture after the given source position (the last one applied on the target)
+    void resumeFrom(std::uint64_t lsn);
     const std::vector<std::string>& getTrackedTables() const;
     const std::vector<std::string>& getPrimaryKeys(const std::string& table) const;
+    const std::vector<std::string>& getColumns(const std::string& table) const;
+    // Column type OIDs, in the same order as getColumns
+    const std::vector<Oid>& getColumnTypes(const std::string& table) const;
+    // SQL type names (with typmod), usable in casts
+    const std::vector<std::string>& getColumnTypeNames(const std::string& table) const;
 
 private:
     SyncLayer::DB::DBConnection* local_;
     std::shared_ptr<SyncLayer::Config::Config> config_;
     std::vector<std::string> trackedTables_;
     std::map<std::string, std::vector<std::string>> tablePrimaryKeys_;
+    std::map<std::string, std::vector<std::string>> tableColumns_;
+    std::map<std::string, std::vector<Oid>> tableColumnTypes_;
+    std::map<std::string, std::vector<std::string>> tableColumnTypeNames_;
+    std::uint64_t lastLsn_ {0};
 };
 
 } // namespace SyncLayer::Tracker
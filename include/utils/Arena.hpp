@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace SyncLayer::Utils {
+
+/**
+ * @brief Bump allocator for data that shares one lifetime, such as a batch of change events.
+ *
+ * Allocations are carved out of large blocks and released together when
+ * the arena is destroyed; there is no per-allocation free.
+ */
+class Arena {
+public:
+    explicit Arena(size_t blockSize = 64 * 1024);
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    char* allocate(size_t n);
+    // Copies bytes into the arena; the view stays valid as long as the arena does.
+    std::string_view copy(std::string_view bytes);
+    // Bytes reserved from the heap so far.
+    size_t capacity() const;
+
+private:
+    size_t blockSize_;
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* cursor_ {nullptr};
+    size_t left_ {0};
+    size_t capacity_ {0};
+};
+
+} // namespace SyncLayer::Utils
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+
+namespace SyncLayer::Utils {
+
+/**
+ * @brief Stops calling an endpoint that keeps failing, then probes it.
+ *
+ * Closed: calls go through. After `failureThreshold` transient failures in
+ * a row the breaker opens, and allow() refuses calls for `cooldown`. Once
+ * the cooldown has passed, one trial call is let through (half-open).
+ * Success closes the breaker and failure opens it again. Thread-safe; one
+ * breaker per endpoint, shared by everything that calls it.
+ */
+class CircuitBreaker {
+public:
+    enum class State { Closed, Open, HalfOpen };
+
+    explicit CircuitBreaker(std::string name, int failureThreshold = 5,
+                            std::chrono::milliseconds cooldown = std::chrono::seconds(30));
+
+    CircuitBreaker(const CircuitBreaker&) = delete;
+    CircuitBreaker& operator=(const CircuitBreaker&) = delete;
+
+    // Whether a call may go out now; the caller must record how it went.
+    bool allow();
+    void recordSuccess();
+    void recordFailure();
+
+    State state() const;
+    const std::string& name() const { return name_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::string name_;
+    int failureThreshold_;
+    std::chrono::milliseconds cooldown_;
+    mutable std::mutex mutex_;
+    State state_ {State::Closed};
+    int failures_ {0};
+    bool probing_ {false}; // half-open and the trial call is out
+    Clock::time_point openedAt_;
+};
+
+} // namespace SyncLayer::Utils
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace SyncLayer::Utils {
+
+class Crc32 {
+public:
+    // CRC-32 (IEEE 802.3); pass a previous result as `crc` to continue over more data.
+    static std::uint32_t compute(const void* data, size_t len, std::uint32_t crc = 0);
+};
+
+} // namespace SyncLayer::Utils
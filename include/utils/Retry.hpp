@@ -5,11 +5,37 @@
 
 namespace SyncLayer::Utils {
 
+class CircuitBreaker;
+
 class Retry {
 public:
+    // What one attempt's result says about trying again.
+    enum class Outcome {
+        Succeeded,
+        Transient, // may work next time (contention): retried
+        Unavailable, // the endpoint is unreachable or shutting down: retried, and counts against its breaker
+        Permanent, // will fail the same way again (bad SQL, a constraint): not retried
+        Rejected,  // returned by run() only: the breaker was open, so nothing was tried
+    };
+
+    struct Policy {
+        int maxAttempts {3};
+        std::chrono::milliseconds base {100};
+        std::chrono::milliseconds cap {10000};
+        // The endpoint's breaker, if any; only Unavailable attempts count against it
+        CircuitBreaker* breaker {nullptr};
+    };
+
+    // Attempts until one succeeds or fails permanently, or maxAttempts are
+    // used up, sleeping nextDelay() between them; returns the last outcome.
+    static Outcome run(const Policy& policy, const std::function<Outcome(int)>& attemptFn);
+    // Every failure counts as transient.
     static void withExponentialBackoff(int maxAttempts, std::function<bool(int)> attemptFn);
+
+    // Decorrelated jitter: uniform in [base, 3 * previous], at most cap. Spreads
+    // out retries from many callers that failed at the same moment.
+    static std::chrono::milliseconds nextDelay(std::chrono::milliseconds previous, std::chrono::milliseconds base,
+                                               std::chrono::milliseconds cap);
 };
 
 } // namespace SyncLayer::Utils
-
-
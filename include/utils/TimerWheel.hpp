@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace SyncLayer::Utils {
+
+/**
+ * @brief Hierarchical timing wheel: O(1) schedule, amortised O(1) expiry.
+ *
+ * Time moves in ticks. Level 0 has one slot per tick for the next 64
+ * ticks, and each level above covers 64 times the span of the one below.
+ * An item goes into the coarsest level that still tells its slot apart.
+ * Whenever level 0 wraps, the next slot of the level above is cascaded
+ * down. Items come due at tick granularity, rounded up, never early.
+ * Past the top level's span (64^4 ticks, about 4.6 hours at 1 ms) they
+ * wait in the last slot and are cascaded again. Not thread-safe.
+ */
+template <typename T>
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit TimerWheel(std::chrono::milliseconds tick = std::chrono::milliseconds(1),
+                        Clock::time_point start = Clock::now())
+        : tick_(tick.count() > 0 ? tick : std::chrono::milliseconds(1)), start_(start) {}
+
+    void schedule(std::chrono::milliseconds delay, T item, Clock::time_point now = Clock::now())
+    {
+        // Rounded up to whole ticks, so nothing fires early
+        const auto at = std::chrono::ceil<std::chrono::milliseconds>(now + delay - start_);
+        const auto ticks = (at + tick_ - std::chrono::milliseconds(1)) / tick_;
+        const std::uint64_t due = at.count() <= 0 ? 0 : static_cast<std::uint64_t>(ticks);
+        place(Entry{ std::max(due, now_ + 1), std::move(item) });
+        ++size_;
+    }
+
+    // Moves everything due by `now` into out, earliest tick first; returns how many.
+    size_t advance(Clock::time_point now, std::vector<T>& out)
+    {
+        const std::uint64_t target = tickAt(now);
+        if (size_ == 0) {
+            now_ = std::max(now_, target);
+            return 0;
+        }
+        size_t fired = 0;
+        while (now_ < target && size_ > 0) {
+            ++now_;
+            // Refill the lower levels from above when they wrap, coarsest first
+            for (size_t level = kLevels - 1; level > 0; --level) {
+                if (now_ % span(level) != 0) continue;
+                auto entries = std::move(slots_[level][slotOf(now_, level)]);
+                slots_[level][slotOf(now_, level)].clear();
+                for (auto& entry : entries) place(std::move(entry));
+            }
+            auto& due = slots_[0][slotOf(now_, 0)];
+            for (auto& entry : due) out.push_back(std::move(entry.item));
+            fired += due.size();
+            size_ -= due.size();
+            due.clear();
+        }
+        now_ = std::max(now_, target);
+        return fired;
+    }
+
+    // When the earliest item comes due; max() when empty.
+    Clock::time_point nextDue() const
+    {
+        if (size_ == 0) return Clock::time_point::max();
+        std::uint64_t best = UINT64_MAX;
+        for (size_t level = 0; level < kLevels; ++level) {
+            for (size_t i = 1; i <= kSlots; ++i) {
+                // Level 0 slots hold one tick each; a slot above starts at its span boundary
+                const std::uint64_t at = level == 0 ? now_ + i : (now_ / span(level) + i) * span(level);
+                const auto& slot = slots_[level][slotOf(at, level)];
+                if (slot.empty()) continue;
+                for (const auto& entry : slot) best = std::min(best, entry.due);
+                break;
+            }
+        }
+        return start_ + tick_ * static_cast<std::int64_t>(best);
+    }
+
+    bool empty() const { return size_ == 0; }
+    size_t size() const { return size_; }
+
+private:
+    static constexpr size_t kLevels = 4;
+    static constexpr size_t kBits = 6;
+    static constexpr size_t kSlots = size_t(1) << kBits;
+
+    struct Entry {
+        std::uint64_t due; // in ticks since start_
+        T item;
+    };
+
+    static std::uint64_t span(size_t level) { return std::uint64_t(1) << (kBits * level); }
+    static size_t slotOf(std::uint64_t tick, size_t level) { return (tick >> (kBits * level)) & (kSlots - 1); }
+
+    std::uint64_t tickAt(Clock::time_point t) const
+    {
+        if (t <= start_) return 0;
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(t - start_) / tick_);
+    }
+
+    void place(Entry&& entry)
+    {
+        // 0 only when cascaded in the tick it is due: level 0's current slot, which is expired next
+        const std::uint64_t delta = entry.due > now_ ? entry.due - now_ : 0;
+        size_t level = 0;
+        while (level + 1 < kLevels && delta >= span(level + 1)) ++level;
+        // Beyond the top level's reach: park in its furthest slot and come back down from there
+        const std::uint64_t at = delta >= span(kLevels) ? now_ + span(kLevels) - span(kLevels - 1)
+                                                        : std::max(entry.due, now_);
+        slots_[level][slotOf(at, level)].push_back(std::move(entry));
+    }
+
+    std::chrono::milliseconds tick_;
+    Clock::time_point start_;
+    std::uint64_t now_ {0};
+    size_t size_ {0};
+    std::array<std::array<std::vector<Entry>, kSlots>, kLevels> slots_;
+};
+
+} // namespace SyncLayer::Utils
@@ -1,6 +1,7 @@
 #include "config/Config.hpp"
 #include "exceptions.hpp"
 #include <yaml-cpp/yaml.h>
+#include <algorithm>
 #include <sstream>
 #include <cstdlib>
 #include <vector>
@@ -64,6 +65,50 @@ void Config::loadFromFile(const std::string& path) {
         intervalSeconds_ = envOrInt("SYNC_INTERVAL_SECONDS", sync["interval_seconds"].as<int>(5));
         batchSize_ = envOrInt("SYNC_BATCH_SIZE", sync["batch_size"].as<int>(50));
         autoFetch_ = envOrBool("SYNC_AUTO_FETCH", sync["auto_fetch"].as<bool>(true));
+        applyWorkers_ = envOrInt("SYNC_APPLY_WORKERS", sync["apply_workers"].as<int>(1));
+        if (applyWorkers_ < 1) applyWorkers_ = 1;
+        applyMode_ = envOr("SYNC_APPLY_MODE", sync["apply_mode"].as<std::string>("hash"));
+        if (applyMode_ != "hash" && applyMode_ != "transaction") {
+            throw SyncLayer::Exception::ConfigurationError("Unknown apply_mode: " + applyMode_);
+        }
+        pipelineName_ = envOr("SYNC_PIPELINE", sync["pipeline"].as<std::string>("default"));
+        queueCapacity_ = envOrInt("SYNC_QUEUE_CAPACITY", sync["queue_capacity"].as<int>(65536));
+        if (queueCapacity_ < 1) queueCapacity_ = 1;
+        queueMemoryMB_ = envOrInt("SYNC_QUEUE_MEMORY_MB", sync["queue_memory_mb"].as<int>(256));
+        if (queueMemoryMB_ < 1) queueMemoryMB_ = 1;
+        queueBackend_ = envOr("SYNC_QUEUE_BACKEND", sync["queue_backend"].as<std::string>("memory"));
+        if (queueBackend_ != "memory" && queueBackend_ != "disk") {
+            throw SyncLayer::Exception::ConfigurationError("Unknown queue_backend: " + queueBackend_);
+        }
+        queueDir_ = envOr("SYNC_QUEUE_DIR", sync["queue_dir"].as<std::string>("data/queue"));
+        queueSegmentMB_ = envOrInt("SYNC_QUEUE_SEGMENT_MB", sync["queue_segment_mb"].as<int>(64));
+        if (queueSegmentMB_ < 1) queueSegmentMB_ = 1;
+        spillDir_ = envOr("SYNC_SPILL_DIR", sync["spill_dir"].as<std::string>("data/spill"));
+        spillMaxMB_ = envOrInt("SYNC_SPILL_MAX_MB", sync["spill_max_mb"].as<int>(0));
+        if (spillMaxMB_ < 0) spillMaxMB_ = 0;
+        applyBatchSize_ = envOrInt("SYNC_APPLY_BATCH_SIZE", sync["apply_batch_size"].as<int>(1000));
+        if (applyBatchSize_ < 1) applyBatchSize_ = 1;
+        applyBatchMB_ = envOrInt("SYNC_APPLY_BATCH_MB", sync["apply_batch_mb"].as<int>(16));
+        if (applyBatchMB_ < 1) applyBatchMB_ = 1;
+        applyMaxWaitMs_ = envOrInt("SYNC_APPLY_MAX_WAIT_MS", sync["apply_max_wait_ms"].as<int>(500));
+        if (applyMaxWaitMs_ < 0) applyMaxWaitMs_ = 0;
+        snapshotFetchRows_ = envOrInt("SYNC_SNAPSHOT_FETCH_ROWS", sync["snapshot_fetch_rows"].as<int>(1000));
+        if (snapshotFetchRows_ < 1) snapshotFetchRows_ = 1;
+        statementTimeoutMs_ = envOrInt("SYNC_STATEMENT_TIMEOUT_MS", sync["statement_timeout_ms"].as<int>(30000));
+        if (statementTimeoutMs_ < 0) statementTimeoutMs_ = 0;
+        lockTimeoutMs_ = envOrInt("SYNC_LOCK_TIMEOUT_MS", sync["lock_timeout_ms"].as<int>(5000));
+        if (lockTimeoutMs_ < 0) lockTimeoutMs_ = 0;
+        applyTimeoutMs_ = envOrInt("SYNC_APPLY_TIMEOUT_MS", sync["apply_timeout_ms"].as<int>(60000));
+        if (applyTimeoutMs_ < 0) applyTimeoutMs_ = 0;
+        lanes_.clear();
+        if (sync["lanes"]) {
+            for (const auto& lane : sync["lanes"]) {
+                LaneSettings settings;
+                settings.weight = std::max(1, lane.second["weight"].as<int>(1));
+                settings.maxLagMs = std::max(0, lane.second["max_lag_ms"].as<int>(0));
+                lanes_[lane.first.as<std::string>()] = settings;
+            }
+        }
         std::vector<std::string> yamlTables;
         if (sync["tables"]) {
             for (const auto& t : sync["tables"]) {
@@ -78,6 +123,18 @@ void Config::loadFromFile(const std::string& path) {
 
         const auto health = root["health"];
         healthPort_ = envOrInt("SYNC_HEALTH_PORT", health["port"].as<int>(8080));
+
+        const auto pool = root["pool"];
+        pools_ = { { "capture", { 1, 1 } }, { "apply", { 1, 1 } }, { "copy", { 0, 1 } }, { "monitoring", { 0, 1 } } };
+        for (auto& [role, settings] : pools_) {
+            if (!pool[role]) continue;
+            settings.max = std::max(1, pool[role]["max"].as<int>(settings.max));
+            settings.min = std::clamp(pool[role]["min"].as<int>(settings.min), 0, settings.max);
+        }
+        poolPingSeconds_ = envOrInt("SYNC_POOL_PING_SECONDS", pool["ping_seconds"].as<int>(30));
+        if (poolPingSeconds_ < 1) poolPingSeconds_ = 1;
+    } catch (const SyncLayer::Exception::ConfigurationError&) {
+        throw;
     } catch (const YAML::BadFile&) {
         throw SyncLayer::Exception::ConfigurationError("Config file not found: " + path);
     } catch (const std::exception& e) {
@@ -90,12 +147,33 @@ std::string Config::getHostedConnString() const { return hostedConn_; }
 int Config::getIntervalSeconds() const { return intervalSeconds_; }
 int Config::getBatchSize() const { return batchSize_; }
 bool Config::getAutoFetch() const { return autoFetch_; }
+int Config::getApplyWorkers() const { return applyWorkers_; }
+std::string Config::getApplyMode() const { return applyMode_; }
+std::string Config::getPipelineName() const { return pipelineName_; }
+int Config::getQueueCapacity() const { return queueCapacity_; }
+int Config::getQueueMemoryMB() const { return queueMemoryMB_; }
+std::string Config::getQueueBackend() const { return queueBackend_; }
+std::string Config::getQueueDir() const { return queueDir_; }
+int Config::getQueueSegmentMB() const { return queueSegmentMB_; }
+std::string Config::getSpillDir() const { return spillDir_; }
+int Config::getSpillMaxMB() const { return spillMaxMB_; }
+int Config::getApplyBatchSize() const { return applyBatchSize_; }
+int Config::getApplyBatchMB() const { return applyBatchMB_; }
+int Config::getApplyMaxWaitMs() const { return applyMaxWaitMs_; }
+int Config::getSnapshotFetchRows() const { return snapshotFetchRows_; }
+int Config::getStatementTimeoutMs() const { return statementTimeoutMs_; }
+int Config::getLockTimeoutMs() const { return lockTimeoutMs_; }
+int Config::getApplyTimeoutMs() const { return applyTimeoutMs_; }
+const std::map<std::string, LaneSettings>& Config::getLanes() const { return lanes_; }
 std::vector<std::string> Config::getTables() const { return tables_; }
 std::string Config::getLogLevel() const { return logLevel_; }
 std::string Config::getLogFile() const { return logFile_; }
 
 int Config::getHealthPort() const { return healthPort_; }
 
+const std::map<std::string, PoolSettings>& Config::getPools() const { return pools_; }
+int Config::getPoolPingSeconds() const { return poolPingSeconds_; }
+
 } // namespace SyncLayer::Config
 
 
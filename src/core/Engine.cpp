@@ -44,6 +44,11 @@ void Engine::run()
     }
 }
 
+void Engine::stop()
+{
+    if (replicationManager_) replicationManager_->stop();
+}
+
 } // namespace SyncLayer::Core
 
 
@@ -0,0 +1,33 @@
+#include "db/Async.hpp"
+#include "db/DBConnection.hpp"
+
+namespace SyncLayer::DB {
+
+namespace {
+
+Result firstFailureOrLast(std::vector<Result>&& results, PGconn* conn)
+{
+    for (auto& res : results) {
+        if (!res.ok() && res.status() != PGRES_COPY_OUT) return std::move(res);
+    }
+    if (results.empty()) return Result(PQmakeEmptyPGresult(conn, PGRES_FATAL_ERROR));
+    return std::move(results.back());
+}
+
+} // namespace
+
+bool AsyncConnection::Awaiter::await_suspend(std::coroutine_handle<> awaiting)
+{
+    auto done = [this, awaiting](std::vector<Result>&& results) {
+        result_ = firstFailureOrLast(std::move(results), conn_->raw());
+        awaiting.resume();
+    };
+    const bool sent = onRow_ ? loop_->copyOut(conn_, sql_, onRow_, std::move(done))
+                             : loop_->query(conn_, sql_, std::move(done));
+    if (sent) return true;
+    // Not suspended: the awaiting coroutine carries on with the error right away
+    result_ = Result(PQmakeEmptyPGresult(conn_->raw(), PGRES_FATAL_ERROR));
+    return false;
+}
+
+} // namespace SyncLayer::DB
@@ -0,0 +1,166 @@
+#include "db/BulkUpsert.hpp"
+#include <algorithm>
+#include <cstdint>
+
+namespace SyncLayer::DB {
+
+namespace {
+
+void appendInt32(std::string& out, std::uint32_t v)
+{
+    out.push_back(static_cast<char>((v >> 24) & 0xff));
+    out.push_back(static_cast<char>((v >> 16) & 0xff));
+    out.push_back(static_cast<char>((v >> 8) & 0xff));
+    out.push_back(static_cast<char>(v & 0xff));
+}
+
+void patchInt32(std::string& out, size_t pos, std::uint32_t v)
+{
+    out[pos] = static_cast<char>((v >> 24) & 0xff);
+    out[pos + 1] = static_cast<char>((v >> 16) & 0xff);
+    out[pos + 2] = static_cast<char>((v >> 8) & 0xff);
+    out[pos + 3] = static_cast<char>(v & 0xff);
+}
+
+std::string quoted(const std::string& name)
+{
+    return "\"" + name + "\"";
+}
+
+} // namespace
+
+BulkUpsert::BulkUpsert(const std::string& table,
+                       const std::vector<std::string>& columns,
+                       const std::vector<Oid>& types,
+                       const std::vector<std::string>& typeNames,
+                       const std::vector<std::string>& primaryKey,
+                       bool updateOnConflict)
+    : types_(types)
+{
+    std::string targets, selects, arrays, aliases, updates;
+    for (size_t j = 0; j < columns.size(); ++j) {
+        const std::string alias = "c" + std::to_string(j + 1);
+        const std::string param = "$" + std::to_string(j + 1);
+        encoders_.push_back(TypeCodec::encoderFor(types[j]));
+        if (j > 0) {
+            targets += ", ";
+            selects += ", ";
+            arrays += ", ";
+            aliases += ", ";
+        }
+        targets += quoted(columns[j]);
+        aliases += alias;
+        if (encoders_.back()) {
+            selects += "u." + alias;
+            arrays += param + "::" + typeNames[j] + "[]";
+        } else {
+            selects += "u." + alias + "::" + typeNames[j];
+            arrays += param + "::text[]";
+        }
+        if (std::find(primaryKey.begin(), primaryKey.end(), columns[j]) == primaryKey.end()) {
+            if (!updates.empty()) updates += ", ";
+            updates += quoted(columns[j]) + " = EXCLUDED." + quoted(columns[j]);
+        }
+    }
+
+    std::string conflict;
+    for (size_t i = 0; i < primaryKey.size(); ++i) {
+        if (i > 0) conflict += ", ";
+        conflict += quoted(primaryKey[i]);
+    }
+
+    sql_ = "INSERT INTO " + table + " (" + targets + ") SELECT " + selects +
+           " FROM unnest(" + arrays + ") AS u(" + aliases + ")";
+    if (updateOnConflict && !conflict.empty() && !updates.empty()) {
+        sql_ += " ON CONFLICT (" + conflict + ") DO UPDATE SET " + updates;
+    } else {
+        sql_ += " ON CONFLICT DO NOTHING";
+    }
+
+    buffers_.resize(columns.size());
+    values_.resize(columns.size());
+    lengths_.resize(columns.size());
+    formats_.resize(columns.size());
+}
+
+const std::string& BulkUpsert::sql() const { return sql_; }
+int BulkUpsert::paramCount() const { return static_cast<int>(types_.size()); }
+const char* const* BulkUpsert::values() const { return values_.data(); }
+const int* BulkUpsert::lengths() const { return lengths_.data(); }
+const int* BulkUpsert::formats() const { return formats_.data(); }
+
+void BulkUpsert::bind(int rows, const CellReader& cell)
+{
+    for (size_t j = 0; j < types_.size(); ++j) {
+        const int column = static_cast<int>(j);
+        // A value the encoder can't represent demotes just this column to a text array
+        if (!encoders_[j] || !bindBinary(column, rows, cell)) {
+            bindText(column, rows, cell);
+        }
+        values_[j] = buffers_[j].data();
+        lengths_[j] = static_cast<int>(buffers_[j].size());
+    }
+}
+
+void BulkUpsert::bindColumns(const ArrayWriter& write)
+{
+    for (size_t j = 0; j < types_.size(); ++j) {
+        formats_[j] = write(static_cast<int>(j), buffers_[j]);
+        values_[j] = buffers_[j].data();
+        lengths_[j] = static_cast<int>(buffers_[j].size());
+    }
+}
+
+bool BulkUpsert::bindBinary(int column, int rows, const CellReader& cell)
+{
+    // array_send layout: ndim, has-null flag, element type, then per
+    // dimension (length, lower bound), then length-prefixed elements
+    std::string& buf = buffers_[column];
+    buf.clear();
+    appendInt32(buf, 1);
+    appendInt32(buf, 0);
+    appendInt32(buf, types_[column]);
+    appendInt32(buf, static_cast<std::uint32_t>(rows));
+    appendInt32(buf, 1);
+    bool hasNull = false;
+    for (int i = 0; i < rows; ++i) {
+        const CellView val = cell(i, column);
+        if (isNull(val)) {
+            appendInt32(buf, 0xffffffffu);
+            hasNull = true;
+            continue;
+        }
+        const size_t lenPos = buf.size();
+        appendInt32(buf, 0);
+        if (!encoders_[column](val.data(), val.size(), buf)) return false;
+        patchInt32(buf, lenPos, static_cast<std::uint32_t>(buf.size() - lenPos - 4));
+    }
+    if (hasNull) patchInt32(buf, 4, 1);
+    formats_[column] = 1;
+    return true;
+}
+
+void BulkUpsert::bindText(int column, int rows, const CellReader& cell)
+{
+    std::string& buf = buffers_[column];
+    buf.clear();
+    buf.push_back('{');
+    for (int i = 0; i < rows; ++i) {
+        if (i > 0) buf.push_back(',');
+        const CellView val = cell(i, column);
+        if (isNull(val)) {
+            buf += "NULL";
+            continue;
+        }
+        buf.push_back('"');
+        for (char ch : val) {
+            if (ch == '"' || ch == '\\') buf.push_back('\\');
+            buf.push_back(ch);
+        }
+        buf.push_back('"');
+    }
+    buf.push_back('}');
+    formats_[column] = 0;
+}
+
+} // namespace SyncLayer::DB
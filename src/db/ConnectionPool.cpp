@@ -0,0 +1,266 @@
+#include "db/ConnectionPool.hpp"
+#include "db/EventLoop.hpp"
+#include "exceptions.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <vector>
+
+namespace SyncLayer::DB {
+
+namespace {
+
+constexpr Role kRoles[] = { Role::Capture, Role::Apply, Role::Copy, Role::Monitoring };
+
+size_t indexOf(Role role) { return static_cast<size_t>(role); }
+
+// Still connected and not left inside a transaction by its last user
+bool reusable(DBConnection* conn)
+{
+    return conn && conn->isOpen() && PQstatus(conn->raw()) == CONNECTION_OK &&
+           PQtransactionStatus(conn->raw()) == PQTRANS_IDLE;
+}
+
+} // namespace
+
+const char* roleName(Role role)
+{
+    switch (role) {
+        case Role::Capture: return "capture";
+        case Role::Apply: return "apply";
+        case Role::Copy: return "copy";
+        case Role::Monitoring: return "monitoring";
+    }
+    return "unknown";
+}
+
+ConnectionPool::Lease::Lease(ConnectionPool* pool, Role role, std::unique_ptr<DBConnection> conn)
+    : pool_(pool), role_(role), conn_(std::move(conn))
+{
+}
+
+ConnectionPool::Lease::~Lease()
+{
+    reset();
+}
+
+ConnectionPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_), role_(other.role_), conn_(std::move(other.conn_))
+{
+    other.pool_ = nullptr;
+}
+
+ConnectionPool::Lease& ConnectionPool::Lease::operator=(Lease&& other) noexcept
+{
+    if (this != &other) {
+        reset();
+        pool_ = other.pool_;
+        role_ = other.role_;
+        conn_ = std::move(other.conn_);
+        other.pool_ = nullptr;
+    }
+    return *this;
+}
+
+void ConnectionPool::Lease::reset()
+{
+    if (pool_ && conn_) pool_->release(role_, std::move(conn_));
+    pool_ = nullptr;
+    conn_.reset();
+}
+
+ConnectionPool::ConnectionPool(std::string name, std::string conninfo,
+                               const std::map<std::string, SyncLayer::Config::PoolSettings>& sizes,
+                               std::chrono::seconds pingInterval)
+    : name_(std::move(name)), conninfo_(std::move(conninfo)), pingInterval_(pingInterval),
+      breaker_(name_ + " database")
+{
+    for (Role role : kRoles) {
+        Slot& slot = slots_[indexOf(role)];
+        auto it = sizes.find(roleName(role));
+        if (it != sizes.end()) {
+            slot.max = static_cast<size_t>(std::max(1, it->second.max));
+            slot.min = std::min(static_cast<size_t>(std::max(0, it->second.min)), slot.max);
+        }
+    }
+    pinger_ = std::thread(&ConnectionPool::run, this);
+}
+
+ConnectionPool::~ConnectionPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (pinger_.joinable()) pinger_.join();
+}
+
+ConnectionPool::Lease ConnectionPool::acquire(Role role, std::chrono::milliseconds timeout)
+{
+    const auto deadline = Clock::now() + timeout;
+    std::unique_lock<std::mutex> lock(mutex_);
+    Slot& slot = slots_[indexOf(role)];
+    while (true) {
+        if (!slot.idle.empty()) {
+            // Most recently returned first: it is the least likely to have gone stale
+            auto conn = std::move(slot.idle.back().conn);
+            slot.idle.pop_back();
+            return Lease(this, role, std::move(conn));
+        }
+        if (slot.open < slot.max) {
+            ++slot.open;
+            lock.unlock();
+            try {
+                auto conn = std::make_unique<DBConnection>(conninfo_);
+                configure(*conn);
+                return Lease(this, role, std::move(conn));
+            } catch (...) {
+                lock.lock();
+                --slot.open;
+                returned_.notify_all();
+                throw;
+            }
+        }
+        if (returned_.wait_until(lock, deadline) == std::cv_status::timeout && slot.idle.empty() &&
+            slot.open >= slot.max) {
+            throw SyncLayer::Exception::DatabaseError("Timed out waiting for a " + std::string(roleName(role)) +
+                                                      " connection to the " + name_ + " database");
+        }
+    }
+}
+
+void ConnectionPool::release(Role role, std::unique_ptr<DBConnection> conn)
+{
+    const bool keep = reusable(conn.get());
+    if (!keep) conn.reset(); // closes outside the lock
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot& slot = slots_[indexOf(role)];
+        if (keep) {
+            slot.idle.push_back(Idle{ std::move(conn), Clock::now() });
+        } else {
+            --slot.open;
+        }
+    }
+    returned_.notify_all();
+}
+
+void ConnectionPool::setSessionParameter(const std::string& name, const std::string& value)
+{
+    session_.emplace_back(name, value);
+}
+
+void ConnectionPool::configure(DBConnection& conn) const
+{
+    for (const auto& [name, value] : session_) {
+        if (!conn.setParameter(name, value)) {
+            spdlog::warn("Could not set {} on a {} connection: {}", name, name_, PQerrorMessage(conn.raw()));
+        }
+    }
+}
+
+void ConnectionPool::warmUp(const std::vector<ConnectionPool*>& pools, std::chrono::milliseconds timeout)
+{
+    const std::string error = fill(pools, timeout);
+    if (!error.empty()) throw SyncLayer::Exception::DatabaseError(error);
+}
+
+std::string ConnectionPool::fill(const std::vector<ConnectionPool*>& pools, std::chrono::milliseconds timeout)
+{
+    EventLoop loop;
+    std::string firstError;
+    size_t opening = 0;
+    for (ConnectionPool* pool : pools) {
+        for (Role role : kRoles) {
+            size_t missing = 0;
+            {
+                std::lock_guard<std::mutex> lock(pool->mutex_);
+                const Slot& slot = pool->slots_[indexOf(role)];
+                if (slot.open < slot.min) missing = slot.min - slot.open;
+            }
+            for (size_t i = 0; i < missing; ++i, ++opening) {
+                loop.connect(pool->conninfo_, [pool, role, &firstError](std::unique_ptr<DBConnection> conn,
+                                                                        const std::string& error) {
+                    if (!conn) {
+                        if (firstError.empty()) firstError = pool->name_ + " database: " + error;
+                        return;
+                    }
+                    pool->configure(*conn);
+                    {
+                        std::lock_guard<std::mutex> lock(pool->mutex_);
+                        Slot& slot = pool->slots_[indexOf(role)];
+                        // acquire() may have opened some meanwhile
+                        if (slot.open >= slot.max) return;
+                        slot.idle.push_back(Idle{ std::move(conn), Clock::now() });
+                        ++slot.open;
+                    }
+                    pool->returned_.notify_all();
+                });
+            }
+        }
+    }
+    if (opening > 0 && !loop.run(timeout) && firstError.empty()) {
+        firstError = "timed out opening " + std::to_string(loop.watched()) + " connection(s)";
+    }
+    return firstError;
+}
+
+void ConnectionPool::pingIdle()
+{
+    for (Role role : kRoles) {
+        // Take the stale ones out so nobody leases them mid-ping
+        std::vector<std::unique_ptr<DBConnection>> stale;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto& idle = slots_[indexOf(role)].idle;
+            const auto cutoff = Clock::now() - pingInterval_;
+            for (auto it = idle.begin(); it != idle.end();) {
+                if (it->since > cutoff) {
+                    ++it;
+                    continue;
+                }
+                stale.push_back(std::move(it->conn));
+                it = idle.erase(it);
+            }
+        }
+        size_t dropped = 0;
+        for (auto& conn : stale) {
+            PGresult* res = PQexec(conn->raw(), "SELECT 1");
+            const bool alive = PQresultStatus(res) == PGRES_TUPLES_OK;
+            PQclear(res);
+            // One reset attempt here, off the callers' path, before giving up on it
+            if (!alive && !conn->ensureConnected(1)) {
+                conn.reset();
+                ++dropped;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            Slot& slot = slots_[indexOf(role)];
+            for (auto& conn : stale) {
+                if (conn) slot.idle.push_back(Idle{ std::move(conn), Clock::now() });
+            }
+            slot.open -= dropped;
+        }
+        if (dropped > 0) {
+            spdlog::warn("Dropped {} dead {} connection(s) to the {} database", dropped, roleName(role), name_);
+            returned_.notify_all();
+        }
+    }
+    const std::string error = fill({ this }, std::chrono::seconds(30));
+    if (!error.empty()) spdlog::warn("Could not top up the {} connection pool: {}", name_, error);
+}
+
+void ConnectionPool::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        wake_.wait_for(lock, pingInterval_, [this] { return stopping_; });
+        if (stopping_) return;
+        lock.unlock();
+        pingIdle();
+        lock.lock();
+    }
+}
+
+} // namespace SyncLayer::DB
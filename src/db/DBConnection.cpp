@@ -1,9 +1,33 @@
 #include "db/DBConnection.hpp"
 #include "exceptions.hpp"
+#include "utils/Retry.hpp"
+#include <spdlog/spdlog.h>
 #include <libpq-fe.h>
 
 namespace SyncLayer::DB {
 
+namespace {
+
+bool applySetting(PGconn* conn, const std::string& name, const std::string& value)
+{
+    // Session-level, unlike SET LOCAL, so it outlives the current transaction
+    const char* params[2] = { name.c_str(), value.c_str() };
+    PGresult* res = PQexecParams(conn, "SELECT set_config($1, $2, false)", 2, nullptr, params, nullptr, nullptr, 0);
+    const bool ok = PQresultStatus(res) == PGRES_TUPLES_OK;
+    PQclear(res);
+    return ok;
+}
+
+bool prepareStatement(PGconn* conn, const std::string& name, const std::string& sql, int nParams)
+{
+    PGresult* res = PQprepare(conn, name.c_str(), sql.c_str(), nParams, nullptr);
+    const bool ok = PQresultStatus(res) == PGRES_COMMAND_OK;
+    PQclear(res);
+    return ok;
+}
+
+} // namespace
+
 DBConnection::DBConnection(const std::string& conninfo)
 {
     conn_ = PQconnectdb(conninfo.c_str());
@@ -15,12 +39,21 @@ DBConnection::DBConnection(const std::string& conninfo)
     }
 }
 
+std::unique_ptr<DBConnection> DBConnection::adopt(PGconn* conn)
+{
+    std::unique_ptr<DBConnection> db(new DBConnection());
+    db->conn_ = conn;
+    return db;
+}
+
 DBConnection::~DBConnection()
 {
     if (conn_) PQfinish(conn_);
 }
 
-DBConnection::DBConnection(DBConnection&& other) noexcept : conn_(other.conn_) {
+DBConnection::DBConnection(DBConnection&& other) noexcept
+    : conn_(other.conn_), settings_(std::move(other.settings_)), prepared_(std::move(other.prepared_)),
+      reconnects_(other.reconnects_) {
     other.conn_ = nullptr;
 }
 
@@ -28,6 +61,9 @@ DBConnection& DBConnection::operator=(DBConnection&& other) noexcept {
     if (this != &other) {
         if (conn_) PQfinish(conn_);
         conn_ = other.conn_;
+        settings_ = std::move(other.settings_);
+        prepared_ = std::move(other.prepared_);
+        reconnects_ = other.reconnects_;
         other.conn_ = nullptr;
     }
     return *this;
@@ -36,6 +72,67 @@ DBConnection& DBConnection::operator=(DBConnection&& other) noexcept {
 bool DBConnection::isOpen() const { return conn_ != nullptr; }
 PGconn* DBConnection::raw() { return conn_; }
 
+bool DBConnection::setParameter(const std::string& name, const std::string& value)
+{
+    if (!applySetting(conn_, name, value)) return false;
+    for (auto& setting : settings_) {
+        if (setting.first != name) continue;
+        setting.second = value;
+        return true;
+    }
+    settings_.emplace_back(name, value);
+    return true;
+}
+
+bool DBConnection::prepare(const std::string& name, const std::string& sql, int nParams)
+{
+    if (!prepareStatement(conn_, name, sql, nParams)) return false;
+    for (auto& statement : prepared_) {
+        if (statement.name != name) continue;
+        statement = Prepared{ name, sql, nParams };
+        return true;
+    }
+    prepared_.push_back(Prepared{ name, sql, nParams });
+    return true;
+}
+
+bool DBConnection::restoreSession()
+{
+    for (const auto& [name, value] : settings_) {
+        if (!applySetting(conn_, name, value)) return false;
+    }
+    for (const auto& statement : prepared_) {
+        if (!prepareStatement(conn_, statement.name, statement.sql, statement.nParams)) return false;
+    }
+    return true;
+}
+
+bool DBConnection::ensureConnected(int maxAttempts)
+{
+    if (!conn_) return false;
+    if (PQstatus(conn_) == CONNECTION_OK) return true;
+
+    spdlog::warn("Database connection lost ({}); reconnecting", PQerrorMessage(conn_));
+    bool restored = false;
+    // PQreset reconnects with the original parameters, so it follows a failover
+    // to wherever the host name now points
+    SyncLayer::Utils::Retry::withExponentialBackoff(maxAttempts, [this, &restored](int attempt) {
+        PQreset(conn_);
+        if (PQstatus(conn_) != CONNECTION_OK) {
+            spdlog::warn("Reconnect attempt {} failed: {}", attempt, PQerrorMessage(conn_));
+            return false;
+        }
+        restored = restoreSession();
+        if (!restored) spdlog::warn("Reconnected, but restoring the session failed: {}", PQerrorMessage(conn_));
+        return restored;
+    });
+    if (!restored) return false;
+    ++reconnects_;
+    spdlog::info("Database connection re-established ({} settings, {} prepared statements restored)",
+                 settings_.size(), prepared_.size());
+    return true;
+}
+
 } // namespace SyncLayer::DB
 
 
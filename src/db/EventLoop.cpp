@@ -0,0 +1,201 @@
+#include "db/EventLoop.hpp"
+#include "db/DBConnection.hpp"
+#include "exceptions.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <utility>
+
+namespace SyncLayer::DB {
+
+namespace {
+
+constexpr int kMaxEvents = 64;
+
+SyncLayer::Exception::DatabaseError epollError(const char* what)
+{
+    return SyncLayer::Exception::DatabaseError(std::string("Event loop ") + what + " failed: " + std::strerror(errno));
+}
+
+} // namespace
+
+EventLoop::EventLoop()
+{
+    epfd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epfd_ < 0) throw epollError("epoll_create1");
+}
+
+EventLoop::~EventLoop()
+{
+    if (epfd_ >= 0) ::close(epfd_);
+}
+
+void EventLoop::watch(int fd, std::uint32_t events, Handler handler)
+{
+    epoll_event ev {};
+    ev.events = events;
+    ev.data.fd = fd;
+    const bool known = handlers_.count(fd) > 0;
+    if (::epoll_ctl(epfd_, known ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &ev) != 0) throw epollError("watch");
+    handlers_[fd] = std::make_shared<Handler>(std::move(handler));
+}
+
+void EventLoop::modify(int fd, std::uint32_t events)
+{
+    epoll_event ev {};
+    ev.events = events;
+    ev.data.fd = fd;
+    if (::epoll_ctl(epfd_, EPOLL_CTL_MOD, fd, &ev) != 0) throw epollError("modify");
+}
+
+void EventLoop::unwatch(int fd)
+{
+    if (handlers_.erase(fd) == 0) return;
+    ::epoll_ctl(epfd_, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+bool EventLoop::query(DBConnection* conn, const std::string& sql, Completion done)
+{
+    return start(conn, sql, nullptr, std::move(done));
+}
+
+bool EventLoop::copyOut(DBConnection* conn, const std::string& sql, RowSink onRow, Completion done)
+{
+    return start(conn, sql, std::move(onRow), std::move(done));
+}
+
+bool EventLoop::start(DBConnection* conn, const std::string& sql, RowSink onRow, Completion done)
+{
+    PGconn* pg = conn->raw();
+    if (!pg || PQsetnonblocking(pg, 1) != 0) return false;
+    if (!PQsendQuery(pg, sql.c_str())) {
+        PQsetnonblocking(pg, 0);
+        return false;
+    }
+
+    struct Pending {
+        std::vector<Result> results;
+        RowSink onRow;
+        Completion done;
+        bool copying {false};
+    };
+    auto pending = std::make_shared<Pending>();
+    pending->onRow = std::move(onRow);
+    pending->done = std::move(done);
+
+    const int fd = PQsocket(pg);
+    const bool moreToSend = PQflush(pg) == 1;
+    watch(fd, EPOLLIN | (moreToSend ? EPOLLOUT : 0u), [this, pg, fd, pending](std::uint32_t events) {
+        if ((events & EPOLLOUT) && PQflush(pg) != 1) modify(fd, EPOLLIN);
+        if (events & (EPOLLIN | EPOLLERR | EPOLLHUP)) PQconsumeInput(pg);
+        while (true) {
+            if (pending->copying) {
+                char* row = nullptr;
+                const int len = PQgetCopyData(pg, &row, 1);
+                if (len == 0) return; // rest of the row hasn't arrived
+                if (len > 0) {
+                    pending->onRow(std::string_view(row, static_cast<size_t>(len)));
+                    PQfreemem(row);
+                    continue;
+                }
+                // -1 is the end of the data, -2 an error; either way the final result follows
+                pending->copying = false;
+            }
+            if (PQisBusy(pg)) return;
+            PGresult* res = PQgetResult(pg);
+            if (res) {
+                if (PQresultStatus(res) == PGRES_COPY_OUT && pending->onRow) {
+                    pending->copying = true;
+                    PQclear(res);
+                } else {
+                    pending->results.emplace_back(res);
+                }
+                continue;
+            }
+            unwatch(fd);
+            PQsetnonblocking(pg, 0);
+            pending->done(std::move(pending->results));
+            return;
+        }
+    });
+    return true;
+}
+
+struct EventLoop::Connecting {
+    PGconn* conn {nullptr};
+    int fd {-1};
+    Connected done;
+
+    // Still set only if the loop went away before startup finished
+    ~Connecting()
+    {
+        if (conn) PQfinish(conn);
+    }
+};
+
+void EventLoop::connect(const std::string& conninfo, Connected done)
+{
+    auto state = std::make_shared<Connecting>();
+    state->conn = PQconnectStart(conninfo.c_str());
+    state->done = std::move(done);
+    if (!state->conn) {
+        state->done(nullptr, "out of memory");
+        return;
+    }
+    // libpq's contract: start as if PQconnectPoll had just asked to write
+    pollConnect(state, PQstatus(state->conn) == CONNECTION_BAD ? PGRES_POLLING_FAILED : PGRES_POLLING_WRITING);
+}
+
+void EventLoop::pollConnect(const std::shared_ptr<Connecting>& state, PostgresPollingStatusType status)
+{
+    // The socket can change between steps (another host or address is tried), so re-register each time
+    if (state->fd >= 0) unwatch(state->fd);
+    state->fd = -1;
+    if (status == PGRES_POLLING_OK) {
+        state->done(DBConnection::adopt(std::exchange(state->conn, nullptr)), std::string());
+        return;
+    }
+    if (status == PGRES_POLLING_FAILED) {
+        const std::string error = PQerrorMessage(state->conn);
+        PQfinish(std::exchange(state->conn, nullptr));
+        state->done(nullptr, error);
+        return;
+    }
+    state->fd = PQsocket(state->conn);
+    watch(state->fd, status == PGRES_POLLING_READING ? EPOLLIN : EPOLLOUT,
+          [this, state](std::uint32_t) { pollConnect(state, PQconnectPoll(state->conn)); });
+}
+
+bool EventLoop::run(std::chrono::milliseconds timeout)
+{
+    using Clock = std::chrono::steady_clock;
+    const bool bounded = timeout != std::chrono::milliseconds::max();
+    const auto deadline = bounded ? Clock::now() + timeout : Clock::time_point::max();
+    epoll_event events[kMaxEvents];
+    while (!handlers_.empty()) {
+        int waitMs = -1;
+        if (bounded) {
+            const auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - Clock::now());
+            if (left.count() <= 0) return false;
+            waitMs = static_cast<int>(std::min<std::chrono::milliseconds::rep>(left.count(), INT32_MAX));
+        }
+        const int n = ::epoll_wait(epfd_, events, kMaxEvents, waitMs);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw epollError("epoll_wait");
+        }
+        for (int i = 0; i < n; ++i) {
+            auto it = handlers_.find(events[i].data.fd);
+            if (it == handlers_.end()) continue; // unwatched by an earlier handler in this round
+            // Held by copy: the handler may unwatch itself
+            const auto handler = it->second;
+            (*handler)(events[i].events);
+        }
+    }
+    return true;
+}
+
+} // namespace SyncLayer::DB
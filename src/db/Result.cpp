@@ -0,0 +1,53 @@
+#include "db/Result.hpp"
+
+namespace SyncLayer::DB {
+
+bool transientSqlstate(std::string_view sqlstate)
+{
+    if (sqlstate.empty() || sqlstate.substr(0, 2) == "08") return true;
+    for (std::string_view state : { "40001", "40P01", "55P03", "53300", "57P01", "57P02", "57P03" }) {
+        if (sqlstate == state) return true;
+    }
+    return false;
+}
+
+bool unavailableSqlstate(std::string_view sqlstate)
+{
+    if (sqlstate.empty() || sqlstate.substr(0, 2) == "08") return true;
+    return sqlstate == "57P01" || sqlstate == "57P02" || sqlstate == "57P03";
+}
+
+Result& Result::operator=(Result&& other) noexcept
+{
+    if (this != &other) {
+        PQclear(res_);
+        res_ = std::exchange(other.res_, nullptr);
+        names_ = std::move(other.names_);
+    }
+    return *this;
+}
+
+std::string_view Result::sqlstate() const
+{
+    const char* state = res_ ? PQresultErrorField(res_, PG_DIAG_SQLSTATE) : nullptr;
+    return state ? state : "";
+}
+
+bool Result::ok() const
+{
+    const ExecStatusType s = PQresultStatus(res_);
+    return res_ && (s == PGRES_COMMAND_OK || s == PGRES_TUPLES_OK);
+}
+
+int Result::column(std::string_view name) const
+{
+    for (const auto& [cached, index] : names_) {
+        if (cached == name) return index;
+    }
+    std::string key(name);
+    const int index = PQfnumber(res_, key.c_str());
+    names_.emplace_back(std::move(key), index);
+    return index;
+}
+
+} // namespace SyncLayer::DB
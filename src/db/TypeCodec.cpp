@@ -0,0 +1,281 @@
+#include "db/TypeCodec.hpp"
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace SyncLayer::DB {
+
+namespace {
+
+template <typename T>
+void appendBigEndian(std::string& out, T value)
+{
+    using U = std::make_unsigned_t<T>;
+    U v = static_cast<U>(value);
+    for (int shift = (sizeof(U) - 1) * 8; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<char>((v >> shift) & 0xff));
+    }
+}
+
+template <typename T>
+bool parseNumber(const char* text, size_t len, T& value)
+{
+    auto [ptr, ec] = std::from_chars(text, text + len, value);
+    return ec == std::errc() && ptr == text + len;
+}
+
+bool equals(const char* text, size_t len, const char* literal)
+{
+    return len == std::strlen(literal) && std::memcmp(text, literal, len) == 0;
+}
+
+template <typename F>
+bool parseFloat(const char* text, size_t len, F& value)
+{
+    if (equals(text, len, "NaN")) { value = std::numeric_limits<F>::quiet_NaN(); return true; }
+    if (equals(text, len, "Infinity")) { value = std::numeric_limits<F>::infinity(); return true; }
+    if (equals(text, len, "-Infinity")) { value = -std::numeric_limits<F>::infinity(); return true; }
+    return parseNumber(text, len, value);
+}
+
+// Reads exactly `width` digits at pos (or, with width 0, one or more digits)
+bool readDigits(const char* text, size_t len, size_t& pos, size_t width, std::int64_t& value)
+{
+    size_t start = pos;
+    value = 0;
+    while (pos < len && text[pos] >= '0' && text[pos] <= '9' && (width == 0 || pos - start < width)) {
+        value = value * 10 + (text[pos] - '0');
+        ++pos;
+    }
+    return pos > start && (width == 0 || pos - start == width);
+}
+
+std::int64_t daysFromCivil(std::int64_t y, unsigned m, unsigned d)
+{
+    y -= m <= 2;
+    const std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<std::int64_t>(doe) - 719468;
+}
+
+// ISO "YYYY-MM-DD HH:MM:SS[.ffffff]" plus, with zone, "+HH[:MM[:SS]]";
+// result is microseconds since 2000-01-01 00:00:00 UTC
+bool parseTimestamp(const char* text, size_t len, bool withZone, std::int64_t& usec)
+{
+    if (equals(text, len, "infinity")) { usec = std::numeric_limits<std::int64_t>::max(); return true; }
+    if (equals(text, len, "-infinity")) { usec = std::numeric_limits<std::int64_t>::min(); return true; }
+
+    size_t pos = 0;
+    std::int64_t year, month, day, hour, minute, second;
+    if (!readDigits(text, len, pos, 0, year) || pos >= len || text[pos++] != '-') return false;
+    if (!readDigits(text, len, pos, 2, month) || pos >= len || text[pos++] != '-') return false;
+    if (!readDigits(text, len, pos, 2, day) || pos >= len || text[pos++] != ' ') return false;
+    if (!readDigits(text, len, pos, 2, hour) || pos >= len || text[pos++] != ':') return false;
+    if (!readDigits(text, len, pos, 2, minute) || pos >= len || text[pos++] != ':') return false;
+    if (!readDigits(text, len, pos, 2, second)) return false;
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 59) return false;
+
+    std::int64_t fraction = 0;
+    if (pos < len && text[pos] == '.') {
+        size_t start = ++pos;
+        if (!readDigits(text, len, pos, 0, fraction) || pos - start > 6) return false;
+        for (size_t i = pos - start; i < 6; ++i) fraction *= 10;
+    }
+
+    std::int64_t offset = 0;
+    if (withZone) {
+        if (pos >= len || (text[pos] != '+' && text[pos] != '-')) return false;
+        const int sign = text[pos++] == '-' ? -1 : 1;
+        std::int64_t oh = 0, om = 0, os = 0;
+        if (!readDigits(text, len, pos, 2, oh)) return false;
+        if (pos < len && text[pos] == ':') { ++pos; if (!readDigits(text, len, pos, 2, om)) return false; }
+        if (pos < len && text[pos] == ':') { ++pos; if (!readDigits(text, len, pos, 2, os)) return false; }
+        offset = sign * (oh * 3600 + om * 60 + os);
+    }
+    // Anything left over (" BC", unexpected zone format) goes as text
+    if (pos != len) return false;
+
+    const std::int64_t days = daysFromCivil(year, static_cast<unsigned>(month), static_cast<unsigned>(day)) - 10957;
+    const std::int64_t seconds = days * 86400 + hour * 3600 + minute * 60 + second - offset;
+    usec = seconds * 1000000 + fraction;
+    return true;
+}
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+} // namespace
+
+TypeCodec::Encoder TypeCodec::encoderFor(Oid type)
+{
+    switch (type) {
+        case TypeOid::Bool: return &encodeBool;
+        case TypeOid::Int2: return &encodeInt2;
+        case TypeOid::Int4: return &encodeInt4;
+        case TypeOid::Int8: return &encodeInt8;
+        case TypeOid::Float4: return &encodeFloat4;
+        case TypeOid::Float8: return &encodeFloat8;
+        case TypeOid::Timestamp: return &encodeTimestamp;
+        case TypeOid::TimestampTz: return &encodeTimestampTz;
+        case TypeOid::Uuid: return &encodeUuid;
+        case TypeOid::Numeric: return &encodeNumeric;
+        default: return nullptr;
+    }
+}
+
+bool TypeCodec::encodeBool(const char* text, size_t len, std::string& out)
+{
+    if (equals(text, len, "t") || equals(text, len, "true")) { out.push_back(1); return true; }
+    if (equals(text, len, "f") || equals(text, len, "false")) { out.push_back(0); return true; }
+    return false;
+}
+
+bool TypeCodec::encodeInt2(const char* text, size_t len, std::string& out)
+{
+    std::int16_t v;
+    if (!parseNumber(text, len, v)) return false;
+    appendBigEndian(out, v);
+    return true;
+}
+
+bool TypeCodec::encodeInt4(const char* text, size_t len, std::string& out)
+{
+    std::int32_t v;
+    if (!parseNumber(text, len, v)) return false;
+    appendBigEndian(out, v);
+    return true;
+}
+
+bool TypeCodec::encodeInt8(const char* text, size_t len, std::string& out)
+{
+    std::int64_t v;
+    if (!parseNumber(text, len, v)) return false;
+    appendBigEndian(out, v);
+    return true;
+}
+
+bool TypeCodec::encodeFloat4(const char* text, size_t len, std::string& out)
+{
+    float v;
+    if (!parseFloat(text, len, v)) return false;
+    std::uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    appendBigEndian(out, bits);
+    return true;
+}
+
+bool TypeCodec::encodeFloat8(const char* text, size_t len, std::string& out)
+{
+    double v;
+    if (!parseFloat(text, len, v)) return false;
+    std::uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    appendBigEndian(out, bits);
+    return true;
+}
+
+bool TypeCodec::encodeTimestamp(const char* text, size_t len, std::string& out)
+{
+    std::int64_t usec;
+    if (!parseTimestamp(text, len, false, usec)) return false;
+    appendBigEndian(out, usec);
+    return true;
+}
+
+bool TypeCodec::encodeTimestampTz(const char* text, size_t len, std::string& out)
+{
+    std::int64_t usec;
+    if (!parseTimestamp(text, len, true, usec)) return false;
+    appendBigEndian(out, usec);
+    return true;
+}
+
+bool TypeCodec::encodeUuid(const char* text, size_t len, std::string& out)
+{
+    char bytes[16];
+    int n = 0;
+    for (size_t i = 0; i < len; ++i) {
+        if (text[i] == '-') continue;
+        int hi = hexValue(text[i]);
+        int lo = i + 1 < len ? hexValue(text[i + 1]) : -1;
+        if (hi < 0 || lo < 0 || n == 16) return false;
+        bytes[n++] = static_cast<char>((hi << 4) | lo);
+        ++i;
+    }
+    if (n != 16) return false;
+    out.append(bytes, sizeof(bytes));
+    return true;
+}
+
+bool TypeCodec::encodeNumeric(const char* text, size_t len, std::string& out)
+{
+    // Wire format: ndigits, weight, sign, dscale, then base-10000 digits, all int16
+    constexpr std::uint16_t positive = 0x0000, negative = 0x4000, nan = 0xC000;
+    if (equals(text, len, "NaN")) {
+        appendBigEndian<std::int16_t>(out, 0);
+        appendBigEndian<std::int16_t>(out, 0);
+        appendBigEndian(out, nan);
+        appendBigEndian<std::int16_t>(out, 0);
+        return true;
+    }
+
+    size_t pos = 0;
+    std::uint16_t sign = positive;
+    if (pos < len && (text[pos] == '-' || text[pos] == '+')) {
+        if (text[pos] == '-') sign = negative;
+        ++pos;
+    }
+    size_t intStart = pos;
+    while (pos < len && text[pos] >= '0' && text[pos] <= '9') ++pos;
+    std::string intPart(text + intStart, pos - intStart);
+    std::string fracPart;
+    if (pos < len && text[pos] == '.') {
+        size_t fracStart = ++pos;
+        while (pos < len && text[pos] >= '0' && text[pos] <= '9') ++pos;
+        fracPart.assign(text + fracStart, pos - fracStart);
+    }
+    // Infinity and exponent forms go as text
+    if (pos != len || (intPart.empty() && fracPart.empty())) return false;
+
+    const size_t firstNonZero = intPart.find_first_not_of('0');
+    intPart = firstNonZero == std::string::npos ? std::string() : intPart.substr(firstNonZero);
+    const std::int16_t dscale = static_cast<std::int16_t>(fracPart.size());
+
+    intPart.insert(0, (4 - intPart.size() % 4) % 4, '0');
+    fracPart.append((4 - fracPart.size() % 4) % 4, '0');
+    std::int16_t weight = static_cast<std::int16_t>(intPart.size() / 4) - 1;
+
+    std::vector<std::int16_t> digits;
+    const std::string all = intPart + fracPart;
+    for (size_t i = 0; i < all.size(); i += 4) {
+        digits.push_back(static_cast<std::int16_t>((all[i] - '0') * 1000 + (all[i + 1] - '0') * 100 +
+                                                   (all[i + 2] - '0') * 10 + (all[i + 3] - '0')));
+    }
+    size_t lead = 0;
+    while (lead < digits.size() && digits[lead] == 0) ++lead;
+    digits.erase(digits.begin(), digits.begin() + lead);
+    weight = static_cast<std::int16_t>(weight - lead);
+    while (!digits.empty() && digits.back() == 0) digits.pop_back();
+    if (digits.empty()) {
+        weight = 0;
+        sign = positive;
+    }
+
+    appendBigEndian(out, static_cast<std::int16_t>(digits.size()));
+    appendBigEndian(out, weight);
+    appendBigEndian(out, sign);
+    appendBigEndian(out, dscale);
+    for (auto d : digits) appendBigEndian(out, d);
+    return true;
+}
+
+} // namespace SyncLayer::DB
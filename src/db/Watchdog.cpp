@@ -0,0 +1,160 @@
+#include "db/Watchdog.hpp"
+#include "db/DBConnection.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace SyncLayer::DB {
+
+Watchdog::Guard::~Guard()
+{
+    disarm();
+}
+
+Watchdog::Guard::Guard(Guard&& other) noexcept
+    : owner_(std::exchange(other.owner_, nullptr)), id_(other.id_), fired_(other.fired_)
+{
+}
+
+Watchdog::Guard& Watchdog::Guard::operator=(Guard&& other) noexcept
+{
+    if (this != &other) {
+        disarm();
+        owner_ = std::exchange(other.owner_, nullptr);
+        id_ = other.id_;
+        fired_ = other.fired_;
+    }
+    return *this;
+}
+
+bool Watchdog::Guard::fired() const
+{
+    if (owner_ && !fired_) fired_ = owner_->hasFired(id_);
+    return fired_;
+}
+
+void Watchdog::Guard::disarm()
+{
+    if (!owner_) return;
+    if (owner_->release(id_)) fired_ = true;
+    owner_ = nullptr;
+}
+
+Watchdog::Watchdog()
+{
+    thread_ = std::thread(&Watchdog::run, this);
+}
+
+Watchdog::~Watchdog()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    changed_.notify_all();
+    if (thread_.joinable()) thread_.join();
+    // Guards should be gone by now, but callbacks still under way must not outlive us
+    std::vector<std::thread> firing;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& [id, entry] : armed_) {
+            if (entry.firing.joinable()) firing.push_back(std::move(entry.firing));
+        }
+    }
+    for (auto& thread : firing) thread.join();
+}
+
+Watchdog::Guard Watchdog::arm(std::chrono::milliseconds timeout, std::function<void()> onExpiry)
+{
+    if (timeout.count() <= 0) return Guard();
+    std::uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        id = nextId_++;
+        armed_.emplace(id, Entry{ Clock::now() + timeout, std::move(onExpiry) });
+    }
+    changed_.notify_all();
+    return Guard(this, id);
+}
+
+Watchdog::Guard Watchdog::cancelOnTimeout(DBConnection* conn, std::chrono::milliseconds timeout)
+{
+    if (timeout.count() <= 0) return Guard();
+    // The cancel handle is taken now: the connection is busy by the time it is needed
+    std::shared_ptr<PGcancel> cancel(PQgetCancel(conn->raw()), PQfreeCancel);
+    if (!cancel) return Guard();
+    return arm(timeout, [cancel, timeout] {
+        char error[256];
+        if (PQcancel(cancel.get(), error, sizeof(error))) {
+            spdlog::warn("Statement still running after {} ms; cancel requested", timeout.count());
+        } else {
+            spdlog::warn("Statement still running after {} ms and could not be canceled: {}", timeout.count(), error);
+        }
+    });
+}
+
+bool Watchdog::release(std::uint64_t id)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = armed_.find(id);
+    if (it == armed_.end()) return false;
+    // A cancel already on its way must land before the caller reuses the connection
+    settled_.wait(lock, [&it] { return it->second.state != State::Firing; });
+    const bool fired = it->second.state == State::Fired;
+    std::thread firing = std::move(it->second.firing);
+    armed_.erase(it);
+    lock.unlock();
+    // Its callback has returned; the thread is only finishing up
+    if (firing.joinable()) firing.join();
+    return fired;
+}
+
+bool Watchdog::hasFired(std::uint64_t id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = armed_.find(id);
+    return it != armed_.end() && it->second.state != State::Armed;
+}
+
+void Watchdog::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        // Few guards are armed at once (one per busy connection), so a scan beats keeping them ordered
+        auto next = Clock::time_point::max();
+        const auto now = Clock::now();
+        std::vector<std::uint64_t> due;
+        for (const auto& [id, entry] : armed_) {
+            if (entry.state != State::Armed) continue;
+            if (entry.deadline <= now) {
+                due.push_back(id);
+            } else {
+                next = std::min(next, entry.deadline);
+            }
+        }
+        for (std::uint64_t id : due) {
+            // Each on its own thread, so a cancel stuck connecting holds up no other deadline.
+            // release() waits out Firing, so the entry stays put while its callback runs.
+            auto& entry = armed_.at(id);
+            entry.state = State::Firing;
+            entry.firing = std::thread(&Watchdog::fire, this, id, std::cref(entry.onExpiry));
+        }
+        if (next == Clock::time_point::max()) {
+            changed_.wait(lock);
+        } else {
+            changed_.wait_until(lock, next);
+        }
+    }
+}
+
+void Watchdog::fire(std::uint64_t id, const std::function<void()>& onExpiry)
+{
+    onExpiry();
+    std::lock_guard<std::mutex> lock(mutex_);
+    armed_.at(id).state = State::Fired;
+    settled_.notify_all();
+}
+
+} // namespace SyncLayer::DB
@@ -80,6 +80,9 @@ void HealthServer::runServer() {
       "size_mb": )" + std::to_string(health.hostedDbSizeMB) + R"(,
       "active_queries": )" + std::to_string(health.hostedActiveQueries) + R"(
     }
+  },
+  "apply": {
+    "skipped_events": )" + std::to_string(health.skippedEvents) + R"(
   }
 }
 )";
@@ -4,8 +4,23 @@
 #include <spdlog/spdlog.h>
 #include <chrono>
 #include <thread>
+#include <atomic>
+#include <csignal>
 #include <cstdlib>
 
+namespace {
+
+std::atomic<bool> stopRequested {false};
+SyncLayer::Core::Engine* runningEngine = nullptr;
+
+void requestStop(int)
+{
+    stopRequested.store(true);
+    if (runningEngine) runningEngine->stop();
+}
+
+} // namespace
+
 std::string getConfigPath() {
     const char* envPath = std::getenv("SYNC_CONFIG_PATH");
     return envPath && *envPath ? std::string(envPath) : "./config/sync-config.yaml";
@@ -20,12 +35,21 @@ int main(int argc, char* argv[]) {
         // 3. Start the Core Engine orchestration loop
         
         SyncLayer::Core::Engine engine(getConfigPath());
+        runningEngine = &engine;
+        std::signal(SIGINT, requestStop);
+        std::signal(SIGTERM, requestStop);
         
-        while (true) {
+        while (!stopRequested.load()) {
             engine.run();
             spdlog::info("Sync completed. Sleeping for 1 hour...");
-            std::this_thread::sleep_for(std::chrono::hours(1));
+            // In steps, so a stop request doesn't wait out the hour
+            const auto wakeAt = std::chrono::steady_clock::now() + std::chrono::hours(1);
+            while (!stopRequested.load() && std::chrono::steady_clock::now() < wakeAt) {
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+            }
         }
+        runningEngine = nullptr;
+        spdlog::info("SyncLayer stopped");
         
     } catch (const SyncLayer::Exception::BaseException& e) {
         spdlog::critical("SyncLayer Critical Error: {}", e.what());
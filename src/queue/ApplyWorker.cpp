@@ -0,0 +1,422 @@
+#include "queue/ApplyWorker.hpp"
+#include "queue/ProgressTable.hpp"
+#include "tracker/TableTracker.hpp"
+#include "db/DBConnection.hpp"
+#include "db/BulkUpsert.hpp"
+#include "db/Result.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cstring>
+
+namespace SyncLayer::Queue {
+
+using SyncLayer::Tracker::ChangeEvent;
+using SyncLayer::Tracker::TableRegistry;
+
+namespace {
+
+// Canceled (statement_timeout or the watchdog's PQcancel) or gave up waiting on a lock (lock_timeout)
+bool timedOut(const PGresult* res)
+{
+    const char* state = PQresultErrorField(res, PG_DIAG_SQLSTATE);
+    return state && (std::strcmp(state, "57014") == 0 || std::strcmp(state, "55P03") == 0);
+}
+
+// Worth retrying later as a whole; no SQLSTATE at all means the connection went away
+bool transient(const PGresult* res)
+{
+    const char* state = PQresultErrorField(res, PG_DIAG_SQLSTATE);
+    return SyncLayer::DB::transientSqlstate(state ? state : "");
+}
+
+} // namespace
+
+EventApplier::EventApplier(const SyncLayer::Tracker::TableTracker* tracker, std::string pipeline,
+                           SyncLayer::DB::Watchdog* watchdog, std::chrono::milliseconds timeout,
+                           SyncLayer::Utils::CircuitBreaker* breaker)
+    : tracker_(tracker), pipeline_(std::move(pipeline)), watchdog_(watchdog), timeout_(timeout), breaker_(breaker) {}
+
+std::string EventApplier::upsertSql(const std::string& table) const
+{
+    const auto& pk = tracker_->getPrimaryKeys(table);
+    if (pk.empty()) return {};
+
+    std::string conflict;
+    for (size_t i = 0; i < pk.size(); ++i) {
+        if (i > 0) conflict += ", ";
+        conflict += "\"" + pk[i] + "\"";
+    }
+
+    const auto& columns = tracker_->getColumns(table);
+    const auto& typeNames = tracker_->getColumnTypeNames(table);
+    std::string targets, params, updates;
+    for (size_t j = 0; j < columns.size(); ++j) {
+        const std::string& col = columns[j];
+        if (j > 0) {
+            targets += ", ";
+            params += ", ";
+        }
+        targets += "\"" + col + "\"";
+        params += "$" + std::to_string(j + 1) + "::" + typeNames[j];
+        bool isKey = false;
+        for (const auto& k : pk) {
+            if (k == col) { isKey = true; break; }
+        }
+        if (isKey) continue;
+        if (!updates.empty()) updates += ", ";
+        updates += "\"" + col + "\" = EXCLUDED.\"" + col + "\"";
+    }
+
+    std::string sql = "INSERT INTO " + table + " (" + targets + ") VALUES (" + params + ")"
+                      " ON CONFLICT (" + conflict + ")";
+    sql += updates.empty() ? " DO NOTHING" : " DO UPDATE SET " + updates;
+    return sql;
+}
+
+void EventApplier::refresh()
+{
+    statements_.clear();
+    for (const auto& table : tracker_->getTrackedTables()) {
+        Statement stmt;
+        stmt.sql = upsertSql(table);
+        const auto& columns = tracker_->getColumns(table);
+        const auto& typeNames = tracker_->getColumnTypeNames(table);
+        stmt.columns = columns.size();
+        // DELETE FROM t WHERE "id" = $1::integer
+        // DELETE FROM t AS d USING unnest($1::integer[]) AS u(k1) WHERE d."id" = u.k1
+        std::string where, arrays, aliases, join;
+        for (const auto& key : tracker_->getPrimaryKeys(table)) {
+            const size_t j = static_cast<size_t>(std::find(columns.begin(), columns.end(), key) - columns.begin());
+            if (j == columns.size()) continue;
+            const std::string n = std::to_string(stmt.keys.size() + 1);
+            if (!stmt.keys.empty()) {
+                where += " AND ";
+                arrays += ", ";
+                aliases += ", ";
+                join += " AND ";
+            }
+            where += "\"" + key + "\" = $" + n + "::" + typeNames[j];
+            arrays += "$" + n + "::" + typeNames[j] + "[]";
+            aliases += "k" + n;
+            join += "d.\"" + key + "\" = u.k" + n;
+            stmt.keys.push_back(j);
+        }
+        if (!stmt.keys.empty()) {
+            stmt.deleteSql = "DELETE FROM " + table + " WHERE " + where;
+            stmt.bulkDeleteSql = "DELETE FROM " + table + " AS d USING unnest(" + arrays + ") AS u(" + aliases +
+                                 ") WHERE " + join;
+        }
+        statements_[TableRegistry::intern(table)] = std::move(stmt);
+    }
+}
+
+bool EventApplier::applicable(const ChangeEvent& event) const
+{
+    // Tables without a primary key can be neither upserted nor deleted from by key
+    auto it = statements_.find(event.table);
+    if (it == statements_.end() || it->second.sql.empty()) {
+        spdlog::warn("Skipping change on {} due to no primary key", TableRegistry::name(event.table));
+        return false;
+    }
+    return true;
+}
+
+EventApplier::Outcome EventApplier::applyOne(SyncLayer::DB::DBConnection* target, const ChangeEvent& event) const
+{
+    const Statement& stmt = statements_.at(event.table);
+    // Column values point straight into the event's payload; the vectors are
+    // reused across events on the same thread
+    thread_local std::vector<const char*> values;
+    thread_local std::vector<int> lengths;
+    values.clear();
+    lengths.clear();
+    if (!SyncLayer::Tracker::ColumnPayload::unpack(event.payload, values, lengths) || values.size() != stmt.columns) {
+        spdlog::error("Failed to apply {} on {}: payload has {} columns, table has {}",
+                      SyncLayer::Tracker::opName(event.op), TableRegistry::name(event.table), values.size(), stmt.columns);
+        return Outcome::Failed;
+    }
+    const std::string* sql = &stmt.sql;
+    if (event.op == SyncLayer::Tracker::Op::Delete) {
+        // A delete's row image only needs its key columns; they go first, in key order
+        thread_local std::vector<const char*> keyValues;
+        keyValues.clear();
+        for (size_t j : stmt.keys) keyValues.push_back(values[j]);
+        values.swap(keyValues);
+        sql = &stmt.deleteSql;
+    }
+    PGresult* res = PQexecParams(target->raw(), sql->c_str(), static_cast<int>(values.size()), nullptr,
+                                 values.data(), nullptr, nullptr, 0);
+    Outcome outcome = Outcome::Applied;
+    if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+        outcome = timedOut(res) ? Outcome::TimedOut : transient(res) ? Outcome::Transient : Outcome::Failed;
+        spdlog::error("Failed to apply {} on {}: {}", SyncLayer::Tracker::opName(event.op),
+                      TableRegistry::name(event.table), PQerrorMessage(target->raw()));
+    }
+    PQclear(res);
+    return outcome;
+}
+
+EventApplier::Outcome EventApplier::applyColumns(SyncLayer::DB::DBConnection* target, ColumnBatch& batch) const
+{
+    const std::string& table = TableRegistry::name(batch.table());
+    batch.coalesce();
+    SyncLayer::DB::BulkUpsert upsert(table, tracker_->getColumns(table), tracker_->getColumnTypes(table),
+                                     tracker_->getColumnTypeNames(table), tracker_->getPrimaryKeys(table), true);
+    upsert.bindColumns([&batch](int column, std::string& out) {
+        return batch.writeArray(static_cast<size_t>(column), out);
+    });
+    PGresult* res = PQexecParams(target->raw(), upsert.sql().c_str(), upsert.paramCount(), nullptr,
+                                 upsert.values(), upsert.lengths(), upsert.formats(), 0);
+    Outcome outcome = Outcome::Applied;
+    if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+        outcome = timedOut(res) ? Outcome::TimedOut : transient(res) ? Outcome::Transient : Outcome::Failed;
+        spdlog::error("Failed to apply {} rows on {}: {}", batch.rows(), table, PQerrorMessage(target->raw()));
+    }
+    PQclear(res);
+    return outcome;
+}
+
+EventApplier::Outcome EventApplier::deleteColumns(SyncLayer::DB::DBConnection* target, ColumnBatch& batch) const
+{
+    const Statement& stmt = statements_.at(batch.table());
+    // Deleting a key twice is the same as once
+    batch.coalesce();
+    std::vector<std::string> arrays(stmt.keys.size());
+    std::vector<const char*> values(stmt.keys.size());
+    std::vector<int> lengths(stmt.keys.size());
+    std::vector<int> formats(stmt.keys.size());
+    for (size_t i = 0; i < stmt.keys.size(); ++i) {
+        formats[i] = batch.writeArray(stmt.keys[i], arrays[i]);
+        values[i] = arrays[i].data();
+        lengths[i] = static_cast<int>(arrays[i].size());
+    }
+    PGresult* res = PQexecParams(target->raw(), stmt.bulkDeleteSql.c_str(), static_cast<int>(values.size()), nullptr,
+                                 values.data(), lengths.data(), formats.data(), 0);
+    Outcome outcome = Outcome::Applied;
+    if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+        outcome = timedOut(res) ? Outcome::TimedOut : transient(res) ? Outcome::Transient : Outcome::Failed;
+        spdlog::error("Failed to delete {} rows on {}: {}", batch.rows(), TableRegistry::name(batch.table()),
+                      PQerrorMessage(target->raw()));
+    }
+    PQclear(res);
+    return outcome;
+}
+
+int EventApplier::applyEvents(SyncLayer::DB::DBConnection* target, const std::vector<ChangeEvent>& events) const
+{
+    // Statements keep the source order across tables (a child row may reference
+    // its parent's); only consecutive changes to one table share a statement
+    std::vector<const ChangeEvent*> applicableEvents;
+    applicableEvents.reserve(events.size());
+    for (const auto& ev : events) {
+        if (applicable(ev)) applicableEvents.push_back(&ev);
+    }
+    const auto groups = statementRuns(applicableEvents);
+
+    auto failed = [](Outcome outcome) {
+        if (outcome == Outcome::TimedOut) return kTimedOut;
+        return outcome == Outcome::Transient ? kTransient : -1;
+    };
+    int applied = 0;
+    for (const auto& group : groups) {
+        if (group.size() > 1) {
+            const auto& table = TableRegistry::name(group.front()->table);
+            ColumnBatch batch(group.front()->table, tracker_->getColumnTypes(table));
+            bool fits = true;
+            for (const auto* ev : group) {
+                if (!batch.append(*ev)) { fits = false; break; }
+            }
+            if (fits) {
+                const bool deletes = group.front()->op == SyncLayer::Tracker::Op::Delete;
+                const Outcome outcome = deletes ? deleteColumns(target, batch) : applyColumns(target, batch);
+                if (outcome != Outcome::Applied) return failed(outcome);
+                applied += static_cast<int>(group.size());
+                continue;
+            }
+            spdlog::debug("Applying {} changes on {} row by row", group.size(), table);
+        }
+        for (const auto* ev : group) {
+            const Outcome outcome = applyOne(target, *ev);
+            if (outcome != Outcome::Applied) return failed(outcome);
+            ++applied;
+        }
+    }
+    return applied;
+}
+
+int EventApplier::applyTransaction(SyncLayer::DB::DBConnection* target, const std::vector<ChangeEvent>& events,
+                                   int slot, std::uint64_t upTo) const
+{
+    if (events.empty() && upTo == 0) return 0;
+    // The target keeps failing: don't add to it, the caller retries later like any transient failure
+    if (breaker_ && !breaker_->allow()) return kTransient;
+    const int result = attempt(target, events, slot, upTo);
+    if (breaker_) {
+        // Any answer from the server, even an error or contention, shows it is up. A lost
+        // connection or a shutdown (see DB::unavailableSqlstate) leaves the connection dead.
+        if (result == kTransient && PQstatus(target->raw()) != CONNECTION_OK) {
+            breaker_->recordFailure();
+        } else {
+            breaker_->recordSuccess();
+        }
+    }
+    return result;
+}
+
+int EventApplier::attempt(SyncLayer::DB::DBConnection* target, const std::vector<ChangeEvent>& events,
+                          int slot, std::uint64_t upTo) const
+{
+    // The deadline covers the whole transaction, so a slow batch can't hold the worker past it
+    auto deadline = watchdog_ ? watchdog_->cancelOnTimeout(target, timeout_) : SyncLayer::DB::Watchdog::Guard();
+    PGresult* res = PQexec(target->raw(), "BEGIN");
+    PQclear(res);
+    int applied = applyEvents(target, events);
+    if (applied < 0) {
+        deadline.disarm();
+        res = PQexec(target->raw(), "ROLLBACK");
+        PQclear(res);
+        return applied;
+    }
+    if (upTo > 0 && !ProgressTable::record(target, pipeline_, slot, upTo)) {
+        deadline.disarm();
+        res = PQexec(target->raw(), "ROLLBACK");
+        PQclear(res);
+        if (deadline.fired()) return kTimedOut;
+        return PQstatus(target->raw()) != CONNECTION_OK ? kTransient : -1;
+    }
+    res = PQexec(target->raw(), "COMMIT");
+    deadline.disarm();
+    int result = applied;
+    if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+        // A serialization failure or a dropped connection surfaces here, not at the statements
+        result = timedOut(res) || deadline.fired() ? kTimedOut : transient(res) ? kTransient : -1;
+    }
+    PQclear(res);
+    return result;
+}
+
+int EventApplier::apply(SyncLayer::DB::DBConnection* target, const std::vector<ChangeEvent>& events,
+                        int slot, std::uint64_t upTo, std::vector<ChangeEvent>* deferred) const
+{
+    int applied = applyTransaction(target, events, slot, upTo);
+    if (applied >= 0) return applied;
+
+    if (applied == kTimedOut && events.size() > 1) {
+        // Too big to finish in time (or stuck behind a lock): halves get a deadline each.
+        // The first half's progress stops at its own last event.
+        const auto middle = events.begin() + static_cast<std::ptrdiff_t>(events.size() / 2);
+        const std::vector<ChangeEvent> head(events.begin(), middle);
+        const std::vector<ChangeEvent> tail(middle, events.end());
+        std::uint64_t headUpTo = 0;
+        for (const auto& ev : head) headUpTo = std::max(headUpTo, ev.lsn);
+        // Lanes interleave tables, so the tail may hold older positions than the head
+        for (const auto& ev : tail) {
+            if (ev.lsn != 0) headUpTo = std::min(headUpTo, ev.lsn - 1);
+        }
+        spdlog::warn("Batch of {} events timed out, retrying as {} and {}", events.size(), head.size(), tail.size());
+        const size_t before = deferred ? deferred->size() : 0;
+        const int headApplied = apply(target, head, slot, std::min(headUpTo, upTo), deferred);
+        if (deferred && deferred->size() > before) {
+            // The tail must not overtake what the head left for later
+            deferred->insert(deferred->end(), tail.begin(), tail.end());
+            return headApplied;
+        }
+        return headApplied + apply(target, tail, slot, upTo, deferred);
+    }
+
+    if (applied == kTransient && deferred) {
+        // Row by row would most likely fail the same way right now; the caller retries it whole later
+        spdlog::warn("Batch of {} events failed transiently; deferring it", events.size());
+        deferred->insert(deferred->end(), events.begin(), events.end());
+        return 0;
+    }
+
+    // One bad row must not hold back the rest of the batch: retry event by event,
+    // each with its own progress update (capped at upTo, like the batch), and skip the ones that still fail,
+    // logging each with its position and counting it in skipped(). A row's progress also stays below every
+    // row after it, which may yet be deferred.
+    spdlog::warn("Batch apply failed, retrying {} events individually", events.size());
+    std::vector<std::uint64_t> below(events.size() + 1, upTo);
+    for (size_t i = events.size(); i-- > 0;) {
+        below[i] = events[i].lsn != 0 ? std::min(below[i + 1], events[i].lsn - 1) : below[i + 1];
+    }
+    applied = 0;
+    for (size_t i = 0; i < events.size(); ++i) {
+        const int n = applyTransaction(target, { events[i] }, slot, std::min(events[i].lsn, below[i + 1]));
+        if (n == kTransient && deferred) {
+            spdlog::warn("Deferring the last {} events after a transient failure", events.size() - i);
+            deferred->insert(deferred->end(), events.begin() + static_cast<std::ptrdiff_t>(i), events.end());
+            return applied;
+        }
+        if (n < 0) {
+            spdlog::error("Skipping {} on {} at source position {}: it fails on its own",
+                          SyncLayer::Tracker::opName(events[i].op), TableRegistry::name(events[i].table),
+                          events[i].lsn);
+            countSkipped(1);
+        }
+        if (n > 0) ++applied;
+    }
+    if (upTo > 0) ProgressTable::record(target, pipeline_, slot, upTo);
+    return applied;
+}
+
+ApplyWorker::ApplyWorker(int id, SyncLayer::DB::ConnectionPool::Lease conn)
+    : id_(id), conn_(std::move(conn))
+{
+    thread_ = std::thread(&ApplyWorker::run, this);
+}
+
+ApplyWorker::~ApplyWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+void ApplyWorker::submit(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.push_back(std::move(task));
+    }
+    cv_.notify_all();
+}
+
+int ApplyWorker::waitIdle()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return pending_.empty() && !busy_; });
+    int applied = applied_;
+    applied_ = 0;
+    return applied;
+}
+
+void ApplyWorker::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+        if (pending_.empty()) return;
+
+        std::vector<Task> tasks;
+        tasks.swap(pending_);
+        busy_ = true;
+        lock.unlock();
+        // Tasks that hit a dropped connection fail on their own; this gets the next ones going again
+        conn_->ensureConnected();
+        int applied = 0;
+        for (auto& task : tasks) {
+            applied += task(conn_.get());
+        }
+        spdlog::debug("Apply worker {} applied {} events", id_, applied);
+        lock.lock();
+        applied_ += applied;
+        busy_ = false;
+        cv_.notify_all();
+    }
+}
+
+} // namespace SyncLayer::Queue
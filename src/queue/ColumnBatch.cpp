@@ -0,0 +1,219 @@
+#include "queue/ColumnBatch.hpp"
+#include "db/TypeCodec.hpp"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace SyncLayer::Queue {
+
+using SyncLayer::DB::TypeCodec;
+namespace TypeOid = SyncLayer::DB::TypeOid;
+
+namespace {
+
+size_t fixedWidth(Oid type)
+{
+    switch (type) {
+    case TypeOid::Bool: return 1;
+    case TypeOid::Int2: return 2;
+    case TypeOid::Int4:
+    case TypeOid::Float4: return 4;
+    case TypeOid::Int8:
+    case TypeOid::Float8:
+    case TypeOid::Timestamp:
+    case TypeOid::TimestampTz: return 8;
+    case TypeOid::Uuid: return 16;
+    default: return 0;
+    }
+}
+
+void appendInt32(std::string& out, std::uint32_t v)
+{
+    const char bytes[4] = { static_cast<char>(v >> 24), static_cast<char>(v >> 16),
+                            static_cast<char>(v >> 8), static_cast<char>(v) };
+    out.append(bytes, 4);
+}
+
+void setValid(std::vector<std::uint64_t>& bits, size_t row)
+{
+    bits[row >> 6] |= std::uint64_t{1} << (row & 63);
+}
+
+} // namespace
+
+ColumnBatch::ColumnBatch(SyncLayer::Tracker::TableId table, const std::vector<Oid>& types)
+    : table_(table)
+{
+    columns_.resize(types.size());
+    for (size_t j = 0; j < types.size(); ++j) {
+        columns_[j].type = types[j];
+        columns_[j].width = fixedWidth(types[j]);
+    }
+}
+
+bool ColumnBatch::append(const SyncLayer::Tracker::ChangeEvent& event)
+{
+    values_.clear();
+    lengths_.clear();
+    if (!SyncLayer::Tracker::ColumnPayload::unpack(event.payload, values_, lengths_) ||
+        values_.size() != columns_.size()) {
+        return false;
+    }
+
+    const size_t row = rows();
+    for (size_t j = 0; j < columns_.size(); ++j) {
+        Column& c = columns_[j];
+        if ((row & 63) == 0) c.valid.push_back(0);
+        const char* value = values_[j];
+        const size_t len = static_cast<size_t>(lengths_[j]);
+        if (c.width > 0) {
+            if (!value) {
+                c.data.append(c.width, '\0');
+                continue;
+            }
+            // A value with no fixed-width form (e.g. 'infinity', BC dates) can't join the batch
+            const size_t before = c.data.size();
+            if (!TypeCodec::encoderFor(c.type)(value, len, c.data) || c.data.size() != before + c.width) {
+                truncate(row);
+                return false;
+            }
+        } else {
+            c.text.emplace_back(value ? std::string_view(value, len) : std::string_view());
+        }
+        if (value) setValid(c.valid, row);
+    }
+    keys_.push_back(event.key);
+    keyHashes_.push_back(event.rowHash());
+    return true;
+}
+
+void ColumnBatch::truncate(size_t rows)
+{
+    const size_t words = (rows + 63) / 64;
+    for (auto& c : columns_) {
+        if (c.width > 0) {
+            c.data.resize(rows * c.width);
+        } else {
+            c.text.resize(rows);
+        }
+        c.valid.resize(words);
+        if (rows & 63) c.valid.back() &= (std::uint64_t{1} << (rows & 63)) - 1;
+    }
+}
+
+void ColumnBatch::coalesce()
+{
+    // Walk backwards so the first occurrence seen is the newest
+    const size_t n = rows();
+    std::vector<std::uint32_t> keep;
+    keep.reserve(n);
+    std::unordered_multimap<std::size_t, std::uint32_t> seen;
+    seen.reserve(n);
+    for (size_t i = n; i-- > 0;) {
+        auto [it, end] = seen.equal_range(keyHashes_[i]);
+        bool superseded = false;
+        for (; it != end; ++it) {
+            if (keys_[it->second] == keys_[i]) {
+                superseded = true;
+                break;
+            }
+        }
+        if (superseded) continue;
+        seen.emplace(keyHashes_[i], static_cast<std::uint32_t>(i));
+        keep.push_back(static_cast<std::uint32_t>(i));
+    }
+    if (keep.size() == n) return;
+    std::reverse(keep.begin(), keep.end());
+    gather(keep);
+}
+
+void ColumnBatch::gather(const std::vector<std::uint32_t>& keep)
+{
+    const size_t words = (keep.size() + 63) / 64;
+    for (auto& c : columns_) {
+        std::vector<std::uint64_t> valid(words, 0);
+        if (c.width > 0) {
+            std::string data(keep.size() * c.width, '\0');
+            for (size_t k = 0; k < keep.size(); ++k) {
+                std::memcpy(&data[k * c.width], &c.data[keep[k] * c.width], c.width);
+            }
+            c.data.swap(data);
+        } else {
+            for (size_t k = 0; k < keep.size(); ++k) c.text[k] = c.text[keep[k]];
+            c.text.resize(keep.size());
+        }
+        for (size_t k = 0; k < keep.size(); ++k) {
+            if (c.isValid(keep[k])) setValid(valid, k);
+        }
+        c.valid.swap(valid);
+    }
+
+    // keep is ascending, so compacting in place never overwrites a row still to be read
+    for (size_t k = 0; k < keep.size(); ++k) {
+        keys_[k] = keys_[keep[k]];
+        keyHashes_[k] = keyHashes_[keep[k]];
+    }
+    keys_.resize(keep.size());
+    keyHashes_.resize(keep.size());
+}
+
+std::vector<std::vector<const SyncLayer::Tracker::ChangeEvent*>>
+statementRuns(const std::vector<const SyncLayer::Tracker::ChangeEvent*>& events)
+{
+    using SyncLayer::Tracker::Op;
+    std::vector<std::vector<const SyncLayer::Tracker::ChangeEvent*>> runs;
+    for (const auto* ev : events) {
+        if (runs.empty() || runs.back().front()->table != ev->table ||
+            (runs.back().front()->op == Op::Delete) != (ev->op == Op::Delete)) {
+            runs.emplace_back();
+        }
+        runs.back().push_back(ev);
+    }
+    return runs;
+}
+
+int ColumnBatch::writeArray(size_t j, std::string& out) const
+{
+    const Column& c = columns_[j];
+    const size_t n = rows();
+    out.clear();
+    if (c.width > 0) {
+        // array_send layout; values are already in wire format
+        bool hasNull = false;
+        for (size_t i = 0; i < n && !hasNull; ++i) hasNull = !c.isValid(i);
+        out.reserve(20 + n * (4 + c.width));
+        appendInt32(out, 1);
+        appendInt32(out, hasNull ? 1 : 0);
+        appendInt32(out, c.type);
+        appendInt32(out, static_cast<std::uint32_t>(n));
+        appendInt32(out, 1);
+        for (size_t i = 0; i < n; ++i) {
+            if (!c.isValid(i)) {
+                appendInt32(out, 0xffffffffu);
+                continue;
+            }
+            appendInt32(out, static_cast<std::uint32_t>(c.width));
+            out.append(c.data, i * c.width, c.width);
+        }
+        return 1;
+    }
+
+    out.push_back('{');
+    for (size_t i = 0; i < n; ++i) {
+        if (i > 0) out.push_back(',');
+        if (!c.isValid(i)) {
+            out += "NULL";
+            continue;
+        }
+        out.push_back('"');
+        for (char ch : c.text[i]) {
+            if (ch == '"' || ch == '\\') out.push_back('\\');
+            out.push_back(ch);
+        }
+        out.push_back('"');
+    }
+    out.push_back('}');
+    return 0;
+}
+
+} // namespace SyncLayer::Queue
@@ -0,0 +1,92 @@
+#include "queue/EventCodec.hpp"
+#include <cstdint>
+#include <cstring>
+
+namespace SyncLayer::Queue {
+
+namespace {
+
+void putU32(std::string& out, std::uint32_t v)
+{
+    char buf[4];
+    std::memcpy(buf, &v, sizeof(v));
+    out.append(buf, sizeof(buf));
+}
+
+void putU64(std::string& out, std::uint64_t v)
+{
+    char buf[8];
+    std::memcpy(buf, &v, sizeof(v));
+    out.append(buf, sizeof(buf));
+}
+
+void putString(std::string& out, std::string_view s)
+{
+    putU32(out, static_cast<std::uint32_t>(s.size()));
+    out.append(s.data(), s.size());
+}
+
+struct Reader {
+    const char* p;
+    const char* end;
+
+    template <typename T>
+    bool get(T& v)
+    {
+        if (static_cast<size_t>(end - p) < sizeof(T)) return false;
+        std::memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+
+    bool getString(std::string_view& s)
+    {
+        std::uint32_t len;
+        if (!get(len) || static_cast<size_t>(end - p) < len) return false;
+        s = std::string_view(p, len);
+        p += len;
+        return true;
+    }
+};
+
+} // namespace
+
+void EventCodec::encode(const SyncLayer::Tracker::ChangeEvent& event, std::string& out)
+{
+    // Table ids are per process, so the name is what goes to disk
+    putString(out, SyncLayer::Tracker::TableRegistry::name(event.table));
+    out.push_back(static_cast<char>(event.op));
+    putString(out, event.key);
+    putString(out, event.payload);
+    putU64(out, event.txId);
+    putU64(out, event.lsn);
+}
+
+bool EventCodec::decode(const char* data, size_t len, SyncLayer::Tracker::ChangeEvent& event,
+                        const std::shared_ptr<SyncLayer::Utils::Arena>& arena)
+{
+    Reader r { data, data + len };
+    std::string_view table, key, payload;
+    std::uint8_t op;
+    if (!(r.getString(table) && r.get(op) && r.getString(key) && r.getString(payload) &&
+          r.get(event.txId) && r.get(event.lsn) && r.p == r.end) ||
+        op > static_cast<std::uint8_t>(SyncLayer::Tracker::Op::Delete)) {
+        return false;
+    }
+    event.table = SyncLayer::Tracker::TableRegistry::intern(table);
+    event.op = static_cast<SyncLayer::Tracker::Op>(op);
+    event.key = arena->copy(key);
+    event.payload = arena->copy(payload);
+    event.arena = arena;
+    return true;
+}
+
+bool EventCodec::decodeLsn(const char* data, size_t len, std::uint64_t& lsn)
+{
+    // lsn is the trailing field
+    if (len < sizeof(lsn)) return false;
+    std::memcpy(&lsn, data + len - sizeof(lsn), sizeof(lsn));
+    return true;
+}
+
+} // namespace SyncLayer::Queue
@@ -0,0 +1,163 @@
+#include "queue/LaneScheduler.hpp"
+#include "utils/Retry.hpp"
+#include <algorithm>
+
+namespace SyncLayer::Queue {
+
+using SyncLayer::Tracker::ChangeEvent;
+
+namespace {
+
+// Retry delays for a parked lane: decorrelated jitter between these bounds
+constexpr std::chrono::milliseconds kRetryBase(100);
+constexpr std::chrono::milliseconds kRetryCap(10000);
+
+} // namespace
+
+LaneScheduler::LaneScheduler(const std::map<std::string, SyncLayer::Config::LaneSettings>& lanes,
+                             size_t maxRoundBytes)
+    : maxRoundBytes_(maxRoundBytes)
+{
+    for (const auto& [table, settings] : lanes) {
+        settings_[SyncLayer::Tracker::TableRegistry::intern(table)] = settings;
+    }
+}
+
+LaneScheduler::Lane& LaneScheduler::laneFor(SyncLayer::Tracker::TableId table)
+{
+    auto [it, inserted] = index_.emplace(table, lanes_.size());
+    if (inserted) {
+        Lane lane;
+        auto s = settings_.find(table);
+        if (s != settings_.end()) {
+            lane.weight = static_cast<size_t>(s->second.weight);
+            lane.maxLag = std::chrono::milliseconds(s->second.maxLagMs);
+        }
+        lanes_.push_back(std::move(lane));
+    }
+    return lanes_[it->second];
+}
+
+void LaneScheduler::push(ChangeEvent&& event, Clock::time_point arrived)
+{
+    bytes_ += event.footprint();
+    laneFor(event.table).events.push_back(Pending{ std::move(event), arrived });
+    ++size_;
+}
+
+size_t LaneScheduler::take(Lane& lane, size_t n, std::vector<ChangeEvent>& out, size_t& roundLeft)
+{
+    n = std::min(n, lane.events.size());
+    size_t i = 0;
+    for (; i < n; ++i) {
+        const size_t footprint = lane.events.front().event.footprint();
+        // The round's first event is taken whatever its size, so an oversized one can't wedge its lane
+        if (footprint > roundLeft && roundLeft != maxRoundBytes_) break;
+        roundLeft -= std::min(roundLeft, footprint);
+        bytes_ -= footprint;
+        out.push_back(std::move(lane.events.front().event));
+        lane.events.pop_front();
+    }
+    if (i > 0) lane.inFlight = true;
+    size_ -= i;
+    return i;
+}
+
+void LaneScheduler::wake(Clock::time_point now)
+{
+    for (auto& lane : lanes_) {
+        // Served last round and nothing came back: its trouble, if any, is over
+        if (lane.inFlight && !lane.parked) lane.backoff = std::chrono::milliseconds(0);
+        lane.inFlight = false;
+    }
+    std::vector<size_t> due;
+    retries_.advance(now, due);
+    for (size_t index : due) {
+        lanes_[index].parked = false;
+        --parked_;
+    }
+}
+
+void LaneScheduler::defer(std::vector<ChangeEvent>&& events, Clock::time_point now)
+{
+    // Workers hand failures back slot by slot; restore source order so each
+    // lane's head stays its oldest event, which minPendingLsn() relies on
+    std::stable_sort(events.begin(), events.end(),
+                     [](const ChangeEvent& a, const ChangeEvent& b) { return a.lsn < b.lsn; });
+    std::vector<size_t> touched;
+    // Back to the head of each lane, keeping their relative order
+    for (auto it = events.rbegin(); it != events.rend(); ++it) {
+        const auto table = it->table;
+        bytes_ += it->footprint();
+        laneFor(table).events.push_front(Pending{ std::move(*it), now });
+        touched.push_back(index_.at(table));
+        ++size_;
+    }
+    for (size_t index : touched) {
+        Lane& lane = lanes_[index];
+        if (lane.parked) continue;
+        lane.parked = true;
+        lane.inFlight = false;
+        ++parked_;
+        lane.backoff = SyncLayer::Utils::Retry::nextDelay(lane.backoff, kRetryBase, kRetryCap);
+        retries_.schedule(lane.backoff, index, now);
+    }
+}
+
+size_t LaneScheduler::next(std::vector<ChangeEvent>& out, size_t max, Clock::time_point now)
+{
+    wake(now);
+    size_t taken = 0;
+    size_t roundLeft = maxRoundBytes_;
+
+    // Deadline phase: lanes with a lag objective, most urgent first
+    std::vector<Lane*> urgent;
+    for (auto& lane : lanes_) {
+        if (lane.maxLag.count() > 0 && !lane.parked && !lane.events.empty()) urgent.push_back(&lane);
+    }
+    std::sort(urgent.begin(), urgent.end(), [](const Lane* a, const Lane* b) {
+        return a->events.front().arrived + a->maxLag < b->events.front().arrived + b->maxLag;
+    });
+    const size_t deadlineBudget = std::max<size_t>(max / 2, 1);
+    for (Lane* lane : urgent) {
+        if (taken >= deadlineBudget) break;
+        const size_t n = take(*lane, deadlineBudget - taken, out, roundLeft);
+        taken += n;
+        if (n == 0) return taken; // out of bytes for this round
+    }
+
+    // Deficit round-robin over every lane that isn't parked for the rest of the round
+    size_t idle = 0;
+    while (taken < max && idle < lanes_.size()) {
+        Lane& lane = lanes_[cursor_];
+        if (lane.parked || lane.events.empty()) {
+            ++idle;
+            lane.deficit = 0;
+            cursor_ = (cursor_ + 1) % lanes_.size();
+            continue;
+        }
+        idle = 0;
+        if (lane.deficit == 0) lane.deficit = kQuantum * lane.weight;
+        const size_t n = take(lane, std::min(lane.deficit, max - taken), out, roundLeft);
+        if (n == 0) break; // out of bytes for this round
+        taken += n;
+        lane.deficit -= n;
+        if (lane.events.empty()) lane.deficit = 0;
+        if (lane.deficit == 0) cursor_ = (cursor_ + 1) % lanes_.size();
+    }
+    return taken;
+}
+
+std::uint64_t LaneScheduler::minPendingLsn() const
+{
+    // Lanes are FIFO over a position-ordered stream, so each lane's minimum is its head
+    std::uint64_t lsn = 0;
+    for (const auto& lane : lanes_) {
+        if (lane.events.empty() || lane.events.front().event.lsn == 0) continue;
+        const std::uint64_t head = lane.events.front().event.lsn;
+        if (lsn == 0 || head < lsn) lsn = head;
+    }
+    return lsn;
+}
+
+} // namespace SyncLayer::Queue
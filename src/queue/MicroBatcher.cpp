@@ -0,0 +1,38 @@
+#include "queue/MicroBatcher.hpp"
+
+namespace SyncLayer::Queue {
+
+using SyncLayer::Tracker::ChangeEvent;
+
+MicroBatcher::MicroBatcher(size_t maxEvents, size_t maxBytes, std::chrono::milliseconds maxWait, bool keepTransactions)
+    : maxEvents_(maxEvents), maxBytes_(maxBytes), maxWait_(maxWait), keepTransactions_(keepTransactions)
+{
+}
+
+bool MicroBatcher::add(ChangeEvent&& event, std::vector<ChangeEvent>& out)
+{
+    // A full batch waits for the first event of the next transaction before it is cut
+    bool ready = keepTransactions_ && full() && (event.txId == 0 || event.txId != open_.back().txId) &&
+                 flush(out);
+    openBytes_ += event.footprint();
+    open_.push_back(std::move(event));
+    if (!keepTransactions_ && full()) ready = flush(out);
+    return ready;
+}
+
+bool MicroBatcher::flush(std::vector<ChangeEvent>& out)
+{
+    if (open_.empty()) return false;
+    out = std::move(open_);
+    open_.clear();
+    openBytes_ = 0;
+    return true;
+}
+
+bool MicroBatcher::due(size_t events, size_t bytes, std::chrono::milliseconds oldest) const
+{
+    if (events == 0) return false;
+    return events >= maxEvents_ || bytes >= maxBytes_ || oldest >= maxWait_;
+}
+
+} // namespace SyncLayer::Queue
@@ -0,0 +1,61 @@
+#include "queue/ProgressTable.hpp"
+#include "db/DBConnection.hpp"
+#include <spdlog/spdlog.h>
+
+namespace SyncLayer::Queue {
+
+bool ProgressTable::ensure(SyncLayer::DB::DBConnection* target)
+{
+    PGresult* res = PQexec(target->raw(),
+        "CREATE TABLE IF NOT EXISTS synclayer_progress ("
+        " pipeline text NOT NULL,"
+        " slot integer NOT NULL,"
+        " lsn bigint NOT NULL,"
+        " updated_at timestamptz NOT NULL DEFAULT now(),"
+        " PRIMARY KEY (pipeline, slot))");
+    bool ok = PQresultStatus(res) == PGRES_COMMAND_OK;
+    if (!ok) {
+        spdlog::error("Failed to create synclayer_progress: {}", PQerrorMessage(target->raw()));
+    }
+    PQclear(res);
+    return ok;
+}
+
+std::map<int, std::uint64_t> ProgressTable::load(SyncLayer::DB::DBConnection* target, const std::string& pipeline)
+{
+    std::map<int, std::uint64_t> slots;
+    const char* values[1] = { pipeline.c_str() };
+    PGresult* res = PQexecParams(target->raw(),
+        "SELECT slot, lsn FROM synclayer_progress WHERE pipeline = $1",
+        1, nullptr, values, nullptr, nullptr, 0);
+    if (PQresultStatus(res) == PGRES_TUPLES_OK) {
+        int nRows = PQntuples(res);
+        for (int i = 0; i < nRows; ++i) {
+            slots[atoi(PQgetvalue(res, i, 0))] = std::stoull(PQgetvalue(res, i, 1));
+        }
+    } else {
+        spdlog::error("Failed to load progress for pipeline {}: {}", pipeline, PQerrorMessage(target->raw()));
+    }
+    PQclear(res);
+    return slots;
+}
+
+bool ProgressTable::record(SyncLayer::DB::DBConnection* target, const std::string& pipeline, int slot, std::uint64_t lsn)
+{
+    const std::string slotText = std::to_string(slot);
+    const std::string lsnText = std::to_string(lsn);
+    const char* values[3] = { pipeline.c_str(), slotText.c_str(), lsnText.c_str() };
+    PGresult* res = PQexecParams(target->raw(),
+        "INSERT INTO synclayer_progress (pipeline, slot, lsn) VALUES ($1, $2, $3) "
+        "ON CONFLICT (pipeline, slot) DO UPDATE "
+        "SET lsn = GREATEST(synclayer_progress.lsn, EXCLUDED.lsn), updated_at = now()",
+        3, nullptr, values, nullptr, nullptr, 0);
+    bool ok = PQresultStatus(res) == PGRES_COMMAND_OK;
+    if (!ok) {
+        spdlog::error("Failed to record progress for pipeline {} slot {}: {}", pipeline, slot, PQerrorMessage(target->raw()));
+    }
+    PQclear(res);
+    return ok;
+}
+
+} // namespace SyncLayer::Queue
@@ -1,28 +1,547 @@
 #include "queue/QueueHandler.hpp"
+#include "queue/TransactionScheduler.hpp"
+#include "queue/ProgressTable.hpp"
+#include "config/Config.hpp"
 #include "tracker/TableTracker.hpp"
 #include "db/DBConnection.hpp"
+#include "db/ConnectionPool.hpp"
+#include "utils/Retry.hpp"
 #include <spdlog/spdlog.h>
+#include <algorithm>
+#include <iterator>
 
 namespace SyncLayer::Queue {
 
-void QueueHandler::enqueue(const SyncLayer::Tracker::ChangeEvent& event)
+namespace {
+
+// Overflow is compressed and written out in batches of about this size
+constexpr size_t kSpillBatchBytes = 4 * 1024 * 1024;
+
+// Retry delays for held-back transactions; the same bounds as parked lanes
+constexpr std::chrono::milliseconds kRetryBase(100);
+constexpr std::chrono::milliseconds kRetryCap(10000);
+
+} // namespace
+
+QueueHandler::QueueHandler(std::shared_ptr<SyncLayer::Config::Config> config,
+                           const SyncLayer::Tracker::TableTracker* tracker, SyncLayer::DB::ConnectionPool& hosted)
+    : config_(std::move(config)), transactional_(config_->getApplyMode() == "transaction"),
+      watchdog_(config_->getApplyTimeoutMs() > 0 ? std::make_unique<SyncLayer::DB::Watchdog>() : nullptr),
+      applier_(tracker, config_->getPipelineName(), watchdog_.get(),
+               std::chrono::milliseconds(config_->getApplyTimeoutMs()), &hosted.breaker()),
+      q_(static_cast<size_t>(config_->getQueueCapacity())),
+      memoryBudget_(static_cast<size_t>(config_->getQueueMemoryMB()) * 1024 * 1024),
+      batcher_(static_cast<size_t>(config_->getApplyBatchSize()),
+               static_cast<size_t>(config_->getApplyBatchMB()) * 1024 * 1024,
+               std::chrono::milliseconds(config_->getApplyMaxWaitMs()), transactional_)
 {
-    q_.push(event);
+    // A single worker applies inline on the caller's connection
+    const int nWorkers = config_->getApplyWorkers();
+    if (nWorkers > 1) {
+        for (int i = 0; i < nWorkers; ++i) {
+            workers_.push_back(std::make_unique<ApplyWorker>(i, hosted.acquire(SyncLayer::DB::Role::Apply)));
+        }
+        spdlog::info("Started {} apply workers ({} mode)", nWorkers, config_->getApplyMode());
+    }
+    appliedLsn_.assign(std::max<size_t>(workers_.size(), 1), 0);
+
+    if (config_->getQueueBackend() == "disk") {
+        log_ = std::make_unique<SegmentLog>(config_->getQueueDir(),
+                                            static_cast<size_t>(config_->getQueueSegmentMB()) * 1024 * 1024);
+    } else if (config_->getSpillMaxMB() > 0) {
+        spill_ = std::make_unique<SpillStore>(config_->getSpillDir(),
+                                              static_cast<size_t>(config_->getSpillMaxMB()) * 1024 * 1024);
+    }
+
+    // Lanes reorder across tables, which would split source transactions. In
+    // hash mode they're always on: they also park tables whose apply failed transiently.
+    if (!transactional_) {
+        lanes_ = std::make_unique<LaneScheduler>(config_->getLanes(),
+                                                 static_cast<size_t>(config_->getApplyBatchMB()) * 1024 * 1024);
+    } else if (!config_->getLanes().empty()) {
+        spdlog::warn("sync.lanes is ignored in transaction apply mode");
+    }
 }
 
-void QueueHandler::drainTo(SyncLayer::DB::DBConnection* target)
+std::uint64_t QueueHandler::loadProgress(SyncLayer::DB::DBConnection* target)
+{
+    if (!ProgressTable::ensure(target)) return 0;
+    auto slots = ProgressTable::load(target, config_->getPipelineName());
+    if (slots.empty()) {
+        // Nothing ever committed here, so the initial sync copies the source afresh and
+        // supersedes whatever an earlier run left in the disk queue; replaying it would
+        // write older versions over the copied rows
+        if (log_ && log_->lastLsn() > 0) {
+            spdlog::warn("No recorded progress for pipeline {}; discarding the disk queue's backlog",
+                         config_->getPipelineName());
+            log_->discard();
+        }
+        return 0;
+    }
+
+    std::uint64_t resumeAt = slots.begin()->second;
+    for (const auto& [slot, lsn] : slots) resumeAt = std::min(resumeAt, lsn);
+
+    // Per-slot positions only hold while events hash to the same slots; after
+    // a worker-count change, fall back to the common low-water mark
+    bool sameLayout = slots.size() == appliedLsn_.size() && slots.rbegin()->first < static_cast<int>(appliedLsn_.size());
+    for (size_t i = 0; i < appliedLsn_.size(); ++i) {
+        appliedLsn_[i] = sameLayout ? slots[static_cast<int>(i)] : resumeAt;
+    }
+    if (!sameLayout) {
+        spdlog::warn("Progress for pipeline {} was recorded with {} slots, now {}; resuming all from {}",
+                     config_->getPipelineName(), slots.size(), appliedLsn_.size(), resumeAt);
+    }
+    // Events still in the disk queue were captured past the applied position
+    // and will be replayed from there, so capture continues after them
+    if (log_ && resumeAt > 0) resumeAt = std::max(resumeAt, log_->lastLsn());
+    return resumeAt;
+}
+
+void QueueHandler::markEnqueued(size_t bytes, size_t events)
 {
-    // Placeholder: execute SQL against target using libpq
-    int drained = 0;
-    while (!q_.empty()) {
-        const auto& ev = q_.front();
-        spdlog::info("Replicating {} on {}: {}", ev.operation, ev.table, ev.payloadJson);
-        q_.pop();
-        ++drained;
+    events_.fetch_add(events, std::memory_order_relaxed);
+    if (bytes_.fetch_add(bytes, std::memory_order_relaxed) == 0) {
+        oldestEnqueuedAt_.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
     }
-    spdlog::info("Drained {} events to target", drained);
 }
 
-} // namespace SyncLayer::Queue
+std::vector<SyncLayer::Tracker::ChangeEvent> QueueHandler::enqueueBatch(std::vector<SyncLayer::Tracker::ChangeEvent>&& batch)
+{
+    if (batch.empty()) return {};
+    if (log_) {
+        size_t bytes = 0;
+        for (const auto& ev : batch) bytes += ev.footprint();
+        log_->append(batch);
+        markEnqueued(bytes, batch.size());
+        return {};
+    }
+
+    size_t admitted = 0;
+    if (!spilling_.load(std::memory_order_acquire)) {
+        // Admit the prefix that fits the budget; an empty queue always takes
+        // at least one event, so one oversized event can't wedge the pipeline
+        const size_t used = bytes_.load(std::memory_order_relaxed);
+        std::vector<size_t> prefixBytes { 0 };
+        for (const auto& ev : batch) {
+            const size_t next = prefixBytes.back() + ev.footprint();
+            if (used + next > memoryBudget_ && !(prefixBytes.size() == 1 && q_.sizeApprox() == 0)) break;
+            prefixBytes.push_back(next);
+        }
+        const size_t n = prefixBytes.size() - 1;
+        if (n > 0) {
+            admitted = q_.tryPushBatch(batch.data(), n);
+            if (admitted > 0) markEnqueued(prefixBytes[admitted], admitted);
+        }
+    }
+    if (admitted < batch.size() && spill_) admitted += spill(batch, admitted);
+    batch.erase(batch.begin(), batch.begin() + static_cast<std::ptrdiff_t>(admitted));
+    return std::move(batch);
+}
+
+size_t QueueHandler::spill(std::vector<SyncLayer::Tracker::ChangeEvent>& batch, size_t from)
+{
+    std::lock_guard<std::mutex> lock(spillMutex_);
+    if (!spilling_.load(std::memory_order_relaxed)) {
+        spdlog::warn("Queue over memory budget; spilling overflow to {}", config_->getSpillDir());
+        spilling_.store(true, std::memory_order_release);
+    }
+    size_t i = from;
+    for (; i < batch.size(); ++i) {
+        overflowBytes_ += batch[i].footprint();
+        overflow_.push_back(std::move(batch[i]));
+        if (overflowBytes_ < kSpillBatchBytes) continue;
+
+        if (!spill_->write(overflow_)) {
+            // Disk budget exhausted: hand this event back and let capture pause
+            overflowBytes_ -= overflow_.back().footprint();
+            batch[i] = std::move(overflow_.back());
+            overflow_.pop_back();
+            spillFull_.store(true, std::memory_order_relaxed);
+            break;
+        }
+        overflow_.clear();
+        overflowBytes_ = 0;
+    }
+    return i - from;
+}
+
+bool QueueHandler::overBudget() const
+{
+    // The disk backend holds events on disk rather than in memory, and
+    // spilling absorbs overflow until its own disk budget runs out
+    if (log_) return false;
+    if (spill_ && !spillFull_.load(std::memory_order_relaxed)) return false;
+    return bytes_.load(std::memory_order_relaxed) >= memoryBudget_;
+}
+
+size_t QueueHandler::queuedBytes() const
+{
+    return bytes_.load(std::memory_order_relaxed);
+}
+
+std::chrono::milliseconds QueueHandler::applyLag() const
+{
+    if (bytes_.load(std::memory_order_relaxed) == 0) return std::chrono::milliseconds(0);
+    const std::chrono::steady_clock::duration since(oldestEnqueuedAt_.load(std::memory_order_relaxed));
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch() - since);
+}
+
+bool QueueHandler::flushDue() const
+{
+    // Spilled events aren't counted in memory, but spilling means the budget is full anyway
+    if (spilling_.load(std::memory_order_relaxed)) return true;
+    return batcher_.due(events_.load(std::memory_order_relaxed), bytes_.load(std::memory_order_relaxed), applyLag());
+}
+
+size_t QueueHandler::shardFor(const SyncLayer::Tracker::ChangeEvent& event) const
+{
+    // Same (table, key) always lands on the same worker, which keeps per-key order
+    return event.rowHash() % workers_.size();
+}
+
+int QueueHandler::applySharded(std::vector<SyncLayer::Tracker::ChangeEvent> batch, std::uint64_t upTo,
+                               std::vector<SyncLayer::Tracker::ChangeEvent>* deferred)
+{
+    std::vector<std::vector<SyncLayer::Tracker::ChangeEvent>> shards(workers_.size());
+    for (auto& ev : batch) {
+        size_t slot = shardFor(ev);
+        // Already committed by this slot before a restart
+        if (ev.lsn != 0 && ev.lsn <= appliedLsn_[slot]) continue;
+        shards[slot].push_back(std::move(ev));
+    }
+    // Idle slots still advance, so the resume point doesn't lag behind them
+    std::vector<std::vector<SyncLayer::Tracker::ChangeEvent>> failed(workers_.size());
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        auto* slotDeferred = deferred ? &failed[i] : nullptr;
+        workers_[i]->submit(
+            [this, i, upTo, slotDeferred, events = std::move(shards[i])](SyncLayer::DB::DBConnection* conn) {
+                return applier_.apply(conn, events, static_cast<int>(i), upTo, slotDeferred);
+            });
+    }
+    int applied = 0;
+    for (auto& worker : workers_) {
+        applied += worker->waitIdle();
+    }
+    if (deferred) {
+        for (auto& events : failed) {
+            std::move(events.begin(), events.end(), std::back_inserter(*deferred));
+        }
+    }
+    return applied;
+}
 
+int QueueHandler::applyTransactions(SyncLayer::DB::DBConnection* target,
+                                    std::vector<SyncLayer::Tracker::ChangeEvent> batch, std::uint64_t upTo,
+                                    std::vector<SyncLayer::Tracker::ChangeEvent>* deferred, size_t held)
+{
+    // Replayed after a restart. Every recorded position is below all uncommitted work,
+    // whichever slot recorded it (see applyOne), so anything at or below the highest is in.
+    const std::uint64_t committed = *std::max_element(appliedLsn_.begin(), appliedLsn_.end());
+    batch.erase(std::remove_if(batch.begin(), batch.end(),
+                               [committed](const SyncLayer::Tracker::ChangeEvent& ev) {
+                                   return ev.lsn != 0 && ev.lsn <= committed;
+                               }),
+                batch.end());
+    TransactionScheduler scheduler(std::move(batch));
+    // The first `held` events are whole transactions still waiting out a retry
+    size_t heldTxns = 0;
+    for (size_t n = 0; n < held && heldTxns < scheduler.size(); ++heldTxns) {
+        n += scheduler.transaction(heldTxns).events.size();
+    }
+    // Oldest position held back so far; no slot records progress at or past it
+    std::atomic<std::uint64_t> floor {UINT64_MAX};
+    auto holdBack = [&floor](const SourceTransaction& txn) {
+        for (const auto& ev : txn.events) {
+            if (ev.lsn == 0) continue;
+            std::uint64_t current = floor.load();
+            while (ev.lsn < current && !floor.compare_exchange_weak(current, ev.lsn)) {
+            }
+        }
+    };
+    for (size_t i = 0; i < heldTxns; ++i) holdBack(scheduler.transaction(i));
+    std::vector<char> heldBack(scheduler.size(), 0); // each entry written only by its transaction's worker
+
+    // A slot records no position at or past a transaction that hasn't committed yet, on
+    // any slot. So each recorded position covers everything before it: capture resumes
+    // from the lowest, and replayed events at or below the highest are skipped.
+    auto applyOne = [this, &scheduler, &floor, &holdBack, &heldBack, deferred, heldTxns](
+                        SyncLayer::DB::DBConnection* conn, size_t i, int slot, bool ready) {
+        const auto& txn = scheduler.transaction(i);
+        if (deferred && (!ready || i < heldTxns)) {
+            // Waits behind a held-back transaction it depends on, or for its own retry
+            heldBack[i] = 1;
+            holdBack(txn);
+            return 0;
+        }
+        std::uint64_t txnLsn = 0;
+        for (const auto& ev : txn.events) txnLsn = std::max(txnLsn, ev.lsn);
+        // Pending first: a transaction is held back (raising floor) before it counts as done
+        const std::uint64_t cap = std::min(scheduler.oldestPendingLsn(i), floor.load());
+        int applied = applier_.applyTransaction(conn, txn.events, slot, cap == UINT64_MAX ? txnLsn
+                                                                                         : std::min(txnLsn, cap - 1));
+        // A source transaction is applied whole or not at all, so one that times out can't be split
+        const bool retry = applied == EventApplier::kTimedOut || applied == EventApplier::kTransient;
+        if (retry && deferred) {
+            spdlog::warn("Source transaction {} ({} events) {}; retrying it later", txn.txId, txn.events.size(),
+                         applied == EventApplier::kTimedOut ? "timed out" : "failed transiently");
+            heldBack[i] = 1;
+            holdBack(txn);
+        } else if (applied == EventApplier::kTimedOut) {
+            spdlog::error("Source transaction {} ({} events) timed out and was rolled back", txn.txId, txn.events.size());
+        } else if (applied < 0) {
+            spdlog::error("Source transaction {} ({} events) failed to apply and was rolled back; skipping it",
+                          txn.txId, txn.events.size());
+        }
+        if (applied < 0 && !(retry && deferred)) applier_.countSkipped(txn.events.size());
+        return std::max(applied, 0);
+    };
+
+    int applied = 0;
+    if (workers_.empty()) {
+        for (size_t i = 0; i < scheduler.size(); ++i) {
+            applied += applyOne(target, i, 0, scheduler.waitForDependencies(i));
+            scheduler.markDone(i, heldBack[i] != 0);
+        }
+    } else {
+        const auto assignment = scheduler.assign(workers_.size());
+        std::vector<bool> idle(workers_.size(), true);
+        for (size_t i = 0; i < scheduler.size(); ++i) {
+            const size_t w = assignment[i];
+            idle[w] = false;
+            workers_[w]->submit([&scheduler, &heldBack, applyOne, i, w](SyncLayer::DB::DBConnection* conn) {
+                const bool ready = scheduler.waitForDependencies(i);
+                int n = applyOne(conn, i, static_cast<int>(w), ready);
+                scheduler.markDone(i, heldBack[i] != 0);
+                return n;
+            });
+        }
+        for (auto& worker : workers_) {
+            applied += worker->waitIdle();
+        }
+        // Idle slots still advance, once the others' transactions have all committed
+        const std::uint64_t lowest = floor.load();
+        const std::uint64_t idleUpTo = lowest == UINT64_MAX ? upTo : std::min(upTo, lowest - 1);
+        for (size_t w = 0; w < workers_.size(); ++w) {
+            if (!idle[w]) continue;
+            workers_[w]->submit([this, w, idleUpTo](SyncLayer::DB::DBConnection* conn) {
+                return applier_.applyTransaction(conn, {}, static_cast<int>(w), idleUpTo);
+            });
+        }
+        for (size_t w = 0; w < workers_.size(); ++w) {
+            if (idle[w]) workers_[w]->waitIdle();
+        }
+    }
+
+    // Held back whole and in commit order, for the next round to retry
+    if (deferred) {
+        for (size_t i = 0; i < scheduler.size(); ++i) {
+            if (!heldBack[i]) continue;
+            const auto& events = scheduler.transaction(i).events;
+            deferred->insert(deferred->end(), events.begin(), events.end());
+        }
+    }
+    return applied;
+}
+
+void QueueHandler::release(size_t bytes, size_t events)
+{
+    // Events replayed from disk after a restart, or spilled, were never counted in
+    size_t current = bytes_.load(std::memory_order_relaxed);
+    while (!bytes_.compare_exchange_weak(current, current - std::min(current, bytes), std::memory_order_relaxed)) {
+    }
+    current = events_.load(std::memory_order_relaxed);
+    while (!events_.compare_exchange_weak(current, current - std::min(current, events), std::memory_order_relaxed)) {
+    }
+}
+
+int QueueHandler::applyBatch(SyncLayer::DB::DBConnection* target, std::vector<SyncLayer::Tracker::ChangeEvent> batch,
+                             std::uint64_t maxUpTo, std::vector<SyncLayer::Tracker::ChangeEvent>* deferred,
+                             size_t held)
+{
+    std::uint64_t upTo = 0;
+    size_t bytes = 0;
+    const size_t events = batch.size();
+    for (const auto& ev : batch) {
+        upTo = std::max(upTo, ev.lsn);
+        bytes += ev.footprint();
+    }
+    upTo = std::min(upTo, maxUpTo);
+
+    int applied = 0;
+    if (transactional_) {
+        applied = applyTransactions(target, std::move(batch), upTo, deferred, held);
+    } else if (workers_.empty()) {
+        applied = applier_.apply(target, batch, 0, upTo, deferred);
+    } else {
+        applied = applySharded(std::move(batch), upTo, deferred);
+    }
+    // Deferred events are still queued: they keep their budget, and progress stays below them
+    if (deferred) {
+        for (const auto& ev : *deferred) {
+            if (ev.lsn != 0) upTo = std::min(upTo, ev.lsn - 1);
+            bytes -= std::min(bytes, ev.footprint());
+        }
+    }
+    for (auto& lsn : appliedLsn_) lsn = std::max(lsn, upTo);
+    release(bytes, events - (deferred ? std::min(events, deferred->size()) : 0));
+    return applied;
+}
+
+int QueueHandler::applyLanes(SyncLayer::DB::DBConnection* target)
+{
+    int applied = 0;
+    std::vector<SyncLayer::Tracker::ChangeEvent> round;
+    std::vector<SyncLayer::Tracker::ChangeEvent> failed;
+    // Parked lanes sit out until their retry is due; a later drain picks them up
+    while (lanes_->next(round, batcher_.maxEvents()) > 0) {
+        // Progress must stay below anything still waiting, or a restart would skip it
+        const std::uint64_t pending = lanes_->minPendingLsn();
+        applied += applyBatch(target, std::move(round), pending > 0 ? pending - 1 : UINT64_MAX, &failed);
+        round.clear();
+        lanes_->defer(std::move(failed));
+        failed.clear();
+    }
+    return applied;
+}
+
+int QueueHandler::applyHeld(SyncLayer::DB::DBConnection* target, std::vector<SyncLayer::Tracker::ChangeEvent> batch)
+{
+    std::vector<bool> fired;
+    if (heldRetry_.advance(std::chrono::steady_clock::now(), fired) > 0) heldDue_ = true;
+    if (batch.empty() && (held_.empty() || !heldDue_)) return 0;
 
+    // Held transactions are older than anything in the batch, so they lead it. Until
+    // their retry is due they sit out, and so does every transaction that depends on them.
+    const size_t waiting = heldDue_ ? 0 : held_.size();
+    std::vector<SyncLayer::Tracker::ChangeEvent> round = std::move(held_);
+    held_.clear();
+    round.insert(round.end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+    const int applied = applyBatch(target, std::move(round), UINT64_MAX, &held_, waiting);
+    if (held_.empty()) {
+        heldBackoff_ = std::chrono::milliseconds(0);
+    } else if (waiting == 0) {
+        // Tried and held back again (or for the first time): wait a little longer before the next try
+        heldBackoff_ = SyncLayer::Utils::Retry::nextDelay(heldBackoff_, kRetryBase, kRetryCap);
+        heldRetry_.schedule(heldBackoff_, true);
+        heldDue_ = false;
+        spdlog::warn("{} events held back after a transient failure; retrying in {} ms", held_.size(),
+                     heldBackoff_.count());
+    }
+    return applied;
+}
+
+bool QueueHandler::holding() const
+{
+    return (lanes_ && !lanes_->empty()) || !held_.empty();
+}
+
+std::chrono::steady_clock::time_point QueueHandler::nextRetry() const
+{
+    auto due = heldRetry_.nextDue();
+    if (lanes_) due = std::min(due, lanes_->nextRetry());
+    return due;
+}
+
+int QueueHandler::drainFrom(SyncLayer::DB::DBConnection* target, const Source& source, size_t& queued,
+                            const std::function<void()>& checkpoint)
+{
+    if (lanes_) return drainLanes(target, source, queued, checkpoint);
+
+    // Transaction mode: the micro-batcher cuts between source transactions, in commit order
+    int applied = 0;
+    std::vector<SyncLayer::Tracker::ChangeEvent> chunk;
+    std::vector<SyncLayer::Tracker::ChangeEvent> ready;
+    while (source(chunk) > 0) {
+        queued += chunk.size();
+        for (auto& ev : chunk) {
+            if (!batcher_.add(std::move(ev), ready)) continue;
+            applied += applyHeld(target, std::move(ready));
+            ready.clear();
+        }
+        chunk.clear();
+        if (checkpoint && batcher_.empty() && !holding()) checkpoint();
+    }
+    if (batcher_.flush(ready)) {
+        applied += applyHeld(target, std::move(ready));
+    } else if (holding()) {
+        // Held transactions whose retry came due since the last round
+        applied += applyHeld(target, {});
+    }
+    // Events held for a retry keep the disk log from moving past them
+    if (checkpoint && !holding()) checkpoint();
+    return applied;
+}
+
+int QueueHandler::drainLanes(SyncLayer::DB::DBConnection* target, const Source& source, size_t& queued,
+                             const std::function<void()>& checkpoint)
+{
+    int applied = 0;
+    std::vector<SyncLayer::Tracker::ChangeEvent> chunk;
+    bool more = true;
+    while (more) {
+        // Read ahead so each round picks from every table's backlog, not just from
+        // the next stretch of the queue. At least one chunk per pass, so lanes parked
+        // over the budget can't stall the drain.
+        const auto arrived = LaneScheduler::Clock::now();
+        do {
+            more = source(chunk) > 0;
+            queued += chunk.size();
+            for (auto& ev : chunk) lanes_->push(std::move(ev), arrived);
+            chunk.clear();
+        } while (more && lanes_->bytes() < memoryBudget_);
+        // Also serves lanes whose retry came due since the last drain
+        applied += applyLanes(target);
+        // Events parked in a lane keep the disk log from moving past them
+        if (checkpoint && lanes_->empty()) checkpoint();
+    }
+    return applied;
+}
+
+void QueueHandler::drainTo(SyncLayer::DB::DBConnection* target)
+{
+    const auto lag = applyLag();
+    applier_.refresh();
+    size_t queued = 0;
+    int applied = 0;
+    if (log_) {
+        // Make the backlog durable, then apply it; the cursor only moves once
+        // everything read up to it has committed on the target
+        log_->sync();
+        applied = drainFrom(
+            target,
+            [this](std::vector<SyncLayer::Tracker::ChangeEvent>& out) { return log_->readBatch(out, batcher_.maxEvents()); },
+            queued, [this] { log_->commit(); });
+    } else {
+        // Spilled events are all newer than what was in memory, so they follow
+        // it in the same stream. Producers block on the mutex meanwhile, which
+        // keeps their events behind the spilled ones.
+        std::unique_lock<std::mutex> spillLock(spillMutex_, std::defer_lock);
+        applied = drainFrom(
+            target,
+            [this, &spillLock](std::vector<SyncLayer::Tracker::ChangeEvent>& out) -> size_t {
+                const size_t n = q_.tryPopBatch(out, q_.capacity());
+                if (n > 0 || !spilling_.load(std::memory_order_acquire)) return n;
+                if (!spillLock.owns_lock()) spillLock.lock();
+                if (spill_->readNext(out)) return out.size();
+                out = std::move(overflow_);
+                overflow_.clear();
+                overflowBytes_ = 0;
+                return out.size();
+            },
+            queued, nullptr);
+        if (spillLock.owns_lock()) {
+            spillFull_.store(false, std::memory_order_relaxed);
+            spilling_.store(false, std::memory_order_release);
+        }
+    }
+    spdlog::info("Drained {} events to target ({} applied, apply lag {} ms)", queued, applied, lag.count());
+    if (lanes_ && lanes_->parked() > 0) {
+        spdlog::warn("{} events wait in {} lanes parked after transient apply failures", lanes_->size(),
+                     lanes_->parked());
+    }
+    if (!held_.empty()) spdlog::warn("{} events of held-back source transactions wait for a retry", held_.size());
+}
+
+} // namespace SyncLayer::Queue
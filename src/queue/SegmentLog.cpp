@@ -0,0 +1,292 @@
+#include "queue/SegmentLog.hpp"
+#include "queue/EventCodec.hpp"
+#include "utils/Crc32.hpp"
+#include "exceptions.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace SyncLayer::Queue {
+
+using SyncLayer::Tracker::ChangeEvent;
+
+namespace {
+
+constexpr size_t kHeaderBytes = 16;
+constexpr size_t kMaxSpares = 2;
+
+SyncLayer::Exception::ReplicationError ioError(const std::string& what, const std::string& path)
+{
+    return SyncLayer::Exception::ReplicationError("Queue " + what + " failed for " + path + ": " + std::strerror(errno));
+}
+
+} // namespace
+
+SegmentLog::SegmentLog(const std::string& dir, size_t segmentBytes)
+    : dir_(dir), segmentBytes_(segmentBytes)
+{
+    fs::create_directories(dir_);
+
+    std::vector<std::uint64_t> segments;
+    for (const auto& entry : fs::directory_iterator(dir_)) {
+        const std::string name = entry.path().filename().string();
+        if (entry.path().extension() == ".seg") {
+            segments.push_back(std::stoull(entry.path().stem().string()));
+        } else if (name.rfind("spare-", 0) == 0) {
+            if (spares_.size() < kMaxSpares) spares_.push_back(entry.path().string());
+            else fs::remove(entry.path());
+        }
+    }
+    std::sort(segments.begin(), segments.end());
+
+    std::uint64_t cursorSeq = segments.empty() ? 1 : segments.front();
+    std::uint64_t cursorOffset = 0;
+    if (FILE* f = std::fopen((dir_ + "/cursor").c_str(), "rb")) {
+        std::uint64_t saved[2];
+        if (std::fread(saved, sizeof(saved), 1, f) == 1) {
+            cursorSeq = saved[0];
+            cursorOffset = saved[1];
+        }
+        std::fclose(f);
+    }
+    if (segments.empty() || cursorSeq > segments.back()) {
+        segments.assign(1, cursorSeq);
+        cursorOffset = 0;
+    }
+
+    committedSeq_ = segments.front();
+    while (committedSeq_ < cursorSeq) recycle(committedSeq_++);
+
+    // Walk the unconsumed backlog once to find where appends continue
+    read_ = map(cursorSeq, true);
+    readOffset_ = cursorOffset;
+    Segment scan = map(cursorSeq, true);
+    size_t offset = cursorOffset;
+    size_t backlog = 0;
+    while (true) {
+        const char* payload = nullptr;
+        size_t len = recordAt(scan, offset, payload);
+        if (len == 0) {
+            if (scan.seq >= segments.back()) break;
+            std::uint64_t next = scan.seq + 1;
+            unmap(scan);
+            scan = map(next, true);
+            offset = 0;
+            continue;
+        }
+        std::uint64_t lsn = 0;
+        if (EventCodec::decodeLsn(payload, len, lsn)) lastLsn_ = std::max(lastLsn_, lsn);
+        offset += kHeaderBytes + len;
+        ++backlog;
+    }
+    write_ = scan;
+    writeOffset_ = syncedOffset_ = offset;
+    spdlog::info("Opened disk queue {} with {} pending events", dir_, backlog);
+}
+
+SegmentLog::~SegmentLog()
+{
+    sync();
+    unmap(write_);
+    unmap(read_);
+}
+
+std::string SegmentLog::pathFor(std::uint64_t seq) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%020llu.seg", static_cast<unsigned long long>(seq));
+    return dir_ + "/" + name;
+}
+
+SegmentLog::Segment SegmentLog::map(std::uint64_t seq, bool create) const
+{
+    const std::string path = pathFor(seq);
+    Segment seg;
+    seg.seq = seq;
+    seg.fd = ::open(path.c_str(), O_RDWR | (create ? O_CREAT : 0), 0644);
+    if (seg.fd < 0) throw ioError("open", path);
+    struct stat st;
+    if (::fstat(seg.fd, &st) != 0 || (static_cast<size_t>(st.st_size) != segmentBytes_ &&
+                                      ::ftruncate(seg.fd, static_cast<off_t>(segmentBytes_)) != 0)) {
+        ::close(seg.fd);
+        throw ioError("resize", path);
+    }
+    void* data = ::mmap(nullptr, segmentBytes_, PROT_READ | PROT_WRITE, MAP_SHARED, seg.fd, 0);
+    if (data == MAP_FAILED) {
+        ::close(seg.fd);
+        throw ioError("mmap", path);
+    }
+    seg.data = static_cast<char*>(data);
+    return seg;
+}
+
+void SegmentLog::unmap(Segment& seg) const
+{
+    if (seg.data) ::munmap(seg.data, segmentBytes_);
+    if (seg.fd >= 0) ::close(seg.fd);
+    seg = Segment{};
+}
+
+size_t SegmentLog::recordAt(const Segment& seg, size_t offset, const char*& payload) const
+{
+    if (offset + kHeaderBytes > segmentBytes_) return 0;
+    std::uint32_t len, crc;
+    std::uint64_t seq;
+    const char* header = seg.data + offset;
+    std::memcpy(&len, header, 4);
+    std::memcpy(&crc, header + 4, 4);
+    std::memcpy(&seq, header + 8, 8);
+    if (len == 0 || seq != seg.seq || offset + kHeaderBytes + len > segmentBytes_) return 0;
+    payload = header + kHeaderBytes;
+    if (SyncLayer::Utils::Crc32::compute(payload, len) != crc) return 0;
+    return len;
+}
+
+void SegmentLog::append(const ChangeEvent& event)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    appendLocked(event);
+}
+
+void SegmentLog::append(const std::vector<ChangeEvent>& batch)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& ev : batch) appendLocked(ev);
+}
+
+void SegmentLog::appendLocked(const ChangeEvent& event)
+{
+    scratch_.clear();
+    EventCodec::encode(event, scratch_);
+    const size_t need = kHeaderBytes + scratch_.size();
+    if (need > segmentBytes_) {
+        throw SyncLayer::Exception::ReplicationError("Change event of " + std::to_string(need) +
+                                                     " bytes does not fit in a queue segment");
+    }
+    if (writeOffset_ + need > segmentBytes_) roll();
+
+    // Payload first, header last: a torn write fails the CRC and reads as end-of-data
+    char* record = write_.data + writeOffset_;
+    std::memcpy(record + kHeaderBytes, scratch_.data(), scratch_.size());
+    const std::uint32_t len = static_cast<std::uint32_t>(scratch_.size());
+    const std::uint32_t crc = SyncLayer::Utils::Crc32::compute(scratch_.data(), scratch_.size());
+    std::memcpy(record + 4, &crc, 4);
+    std::memcpy(record + 8, &write_.seq, 8);
+    std::memcpy(record, &len, 4);
+    writeOffset_ += need;
+    lastLsn_ = std::max(lastLsn_, event.lsn);
+}
+
+void SegmentLog::sync()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!write_.data || writeOffset_ == syncedOffset_) return;
+    const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    const size_t start = syncedOffset_ / page * page;
+    ::msync(write_.data + start, writeOffset_ - start, MS_SYNC);
+    syncedOffset_ = writeOffset_;
+}
+
+void SegmentLog::roll()
+{
+    ::msync(write_.data, segmentBytes_, MS_SYNC);
+    const std::uint64_t next = write_.seq + 1;
+    unmap(write_);
+    if (!spares_.empty()) {
+        fs::rename(spares_.back(), pathFor(next));
+        spares_.pop_back();
+    }
+    write_ = map(next, true);
+    writeOffset_ = syncedOffset_ = 0;
+}
+
+size_t SegmentLog::readBatch(std::vector<ChangeEvent>& out, size_t max)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    // One arena per batch: the events' keys and payloads are freed together
+    auto arena = std::make_shared<SyncLayer::Utils::Arena>();
+    size_t n = 0;
+    while (n < max) {
+        const char* payload = nullptr;
+        size_t len = recordAt(read_, readOffset_, payload);
+        if (len == 0) {
+            if (read_.seq >= write_.seq) break;
+            std::uint64_t next = read_.seq + 1;
+            unmap(read_);
+            read_ = map(next, false);
+            readOffset_ = 0;
+            continue;
+        }
+        ChangeEvent ev;
+        if (EventCodec::decode(payload, len, ev, arena)) {
+            out.push_back(std::move(ev));
+            ++n;
+        } else {
+            spdlog::error("Skipping undecodable record in queue segment {} at offset {}", read_.seq, readOffset_);
+        }
+        readOffset_ += kHeaderBytes + len;
+    }
+    return n;
+}
+
+void SegmentLog::commit()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    saveCursor();
+    while (committedSeq_ < read_.seq) recycle(committedSeq_++);
+}
+
+void SegmentLog::discard()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (read_.seq != write_.seq) {
+        unmap(read_);
+        read_ = map(write_.seq, false);
+    }
+    readOffset_ = writeOffset_;
+    lastLsn_ = 0;
+    saveCursor();
+    while (committedSeq_ < read_.seq) recycle(committedSeq_++);
+}
+
+std::uint64_t SegmentLog::lastLsn() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastLsn_;
+}
+
+void SegmentLog::recycle(std::uint64_t seq)
+{
+    const std::string path = pathFor(seq);
+    std::error_code ec;
+    if (spares_.size() < kMaxSpares) {
+        const std::string spare = dir_ + "/spare-" + std::to_string(seq);
+        fs::rename(path, spare, ec);
+        if (!ec) spares_.push_back(spare);
+    } else {
+        fs::remove(path, ec);
+    }
+}
+
+void SegmentLog::saveCursor() const
+{
+    // Write-then-rename so a crash leaves either the old or the new cursor
+    const std::string tmp = dir_ + "/cursor.tmp";
+    const std::uint64_t saved[2] = { read_.seq, readOffset_ };
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) throw ioError("open", tmp);
+    bool ok = ::write(fd, saved, sizeof(saved)) == static_cast<ssize_t>(sizeof(saved)) && ::fsync(fd) == 0;
+    ::close(fd);
+    if (!ok || std::rename(tmp.c_str(), (dir_ + "/cursor").c_str()) != 0) throw ioError("cursor write", tmp);
+}
+
+} // namespace SyncLayer::Queue
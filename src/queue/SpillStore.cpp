@@ -0,0 +1,176 @@
+#include "queue/SpillStore.hpp"
+#include "queue/EventCodec.hpp"
+#include "utils/Crc32.hpp"
+#include "exceptions.hpp"
+#include <spdlog/spdlog.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#ifdef SYNCLAYER_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace SyncLayer::Queue {
+
+using SyncLayer::Tracker::ChangeEvent;
+
+namespace {
+
+// File layout: magic, codec, raw size, crc32 of the raw bytes, then the
+// (possibly compressed) block of [u32 length][EventCodec record] entries
+constexpr std::uint32_t kMagic = 0x50534c53; // "SLSP"
+constexpr size_t kHeaderBytes = 4 + 1 + 8 + 4;
+
+enum class Codec : std::uint8_t { None = 0, Zstd = 1 };
+
+#ifdef SYNCLAYER_HAVE_ZSTD
+constexpr Codec kCodec = Codec::Zstd;
+constexpr int kZstdLevel = 1; // spill is on the capture path; favour speed over ratio
+#else
+constexpr Codec kCodec = Codec::None;
+#endif
+
+bool compress(const std::string& raw, std::string& out)
+{
+#ifdef SYNCLAYER_HAVE_ZSTD
+    const size_t start = out.size();
+    out.resize(start + ZSTD_compressBound(raw.size()));
+    const size_t n = ZSTD_compress(&out[start], out.size() - start, raw.data(), raw.size(), kZstdLevel);
+    if (ZSTD_isError(n)) return false;
+    out.resize(start + n);
+#else
+    out += raw;
+#endif
+    return true;
+}
+
+bool decompress(Codec codec, const char* data, size_t len, size_t rawSize, std::string& raw)
+{
+    raw.resize(rawSize);
+    if (codec == Codec::None) {
+        if (len != rawSize) return false;
+        std::memcpy(&raw[0], data, len);
+        return true;
+    }
+#ifdef SYNCLAYER_HAVE_ZSTD
+    if (codec == Codec::Zstd) {
+        const size_t n = ZSTD_decompress(&raw[0], rawSize, data, len);
+        return !ZSTD_isError(n) && n == rawSize;
+    }
+#endif
+    return false;
+}
+
+} // namespace
+
+SpillStore::SpillStore(const std::string& dir, size_t maxBytes)
+    : dir_(dir), maxBytes_(maxBytes)
+{
+    fs::create_directories(dir_);
+    for (const auto& entry : fs::directory_iterator(dir_)) {
+        if (entry.path().extension() == ".spill") fs::remove(entry.path());
+    }
+}
+
+SpillStore::~SpillStore()
+{
+    std::error_code ec;
+    for (const auto& f : files_) fs::remove(f.path, ec);
+}
+
+bool SpillStore::write(const std::vector<ChangeEvent>& batch)
+{
+    raw_.clear();
+    std::string record;
+    for (const auto& ev : batch) {
+        record.clear();
+        EventCodec::encode(ev, record);
+        const std::uint32_t len = static_cast<std::uint32_t>(record.size());
+        raw_.append(reinterpret_cast<const char*>(&len), 4);
+        raw_ += record;
+    }
+
+    packed_.assign(kHeaderBytes, '\0');
+    const std::uint8_t codec = static_cast<std::uint8_t>(kCodec);
+    const std::uint64_t rawSize = raw_.size();
+    const std::uint32_t crc = SyncLayer::Utils::Crc32::compute(raw_.data(), raw_.size());
+    std::memcpy(&packed_[0], &kMagic, 4);
+    std::memcpy(&packed_[4], &codec, 1);
+    std::memcpy(&packed_[5], &rawSize, 8);
+    std::memcpy(&packed_[13], &crc, 4);
+    if (!compress(raw_, packed_)) {
+        throw SyncLayer::Exception::ReplicationError("Failed to compress spill batch");
+    }
+    if (diskBytes_ + packed_.size() > maxBytes_) return false;
+
+    const std::string path = dir_ + "/" + std::to_string(nextSeq_++) + ".spill";
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(packed_.data(), static_cast<std::streamsize>(packed_.size()));
+    if (!out) {
+        throw SyncLayer::Exception::ReplicationError("Failed to write spill file " + path);
+    }
+    files_.push_back(File{ path, packed_.size() });
+    diskBytes_ += packed_.size();
+    spdlog::debug("Spilled {} events ({} bytes, {} compressed) to {}", batch.size(), raw_.size(), packed_.size(), path);
+    return true;
+}
+
+bool SpillStore::readNext(std::vector<ChangeEvent>& out)
+{
+    if (files_.empty()) return false;
+    const File file = files_.front();
+    files_.pop_front();
+    diskBytes_ -= file.bytes;
+
+    std::ifstream in(file.path, std::ios::binary);
+    packed_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    in.close();
+    fs::remove(file.path);
+
+    std::uint32_t magic = 0, crc = 0;
+    std::uint8_t codec = 0;
+    std::uint64_t rawSize = 0;
+    if (packed_.size() >= kHeaderBytes) {
+        std::memcpy(&magic, &packed_[0], 4);
+        std::memcpy(&codec, &packed_[4], 1);
+        std::memcpy(&rawSize, &packed_[5], 8);
+        std::memcpy(&crc, &packed_[13], 4);
+    }
+    if (magic != kMagic ||
+        !decompress(static_cast<Codec>(codec), packed_.data() + kHeaderBytes, packed_.size() - kHeaderBytes, rawSize, raw_) ||
+        SyncLayer::Utils::Crc32::compute(raw_.data(), raw_.size()) != crc) {
+        throw SyncLayer::Exception::ReplicationError("Spill file " + file.path + " is corrupt");
+    }
+
+    // One arena per batch, as for batches read from the segment log
+    auto arena = std::make_shared<SyncLayer::Utils::Arena>();
+    size_t pos = 0;
+    while (pos + 4 <= raw_.size()) {
+        std::uint32_t len;
+        std::memcpy(&len, &raw_[pos], 4);
+        pos += 4;
+        ChangeEvent ev;
+        if (pos + len > raw_.size() || !EventCodec::decode(raw_.data() + pos, len, ev, arena)) {
+            throw SyncLayer::Exception::ReplicationError("Spill file " + file.path + " is corrupt");
+        }
+        out.push_back(std::move(ev));
+        pos += len;
+    }
+    return true;
+}
+
+bool SpillStore::empty() const
+{
+    return files_.empty();
+}
+
+size_t SpillStore::diskBytes() const
+{
+    return diskBytes_;
+}
+
+} // namespace SyncLayer::Queue
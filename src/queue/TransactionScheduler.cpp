@@ -0,0 +1,105 @@
+#include "queue/TransactionScheduler.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+namespace SyncLayer::Queue {
+
+using SyncLayer::Tracker::ChangeEvent;
+
+TransactionScheduler::TransactionScheduler(std::vector<ChangeEvent> events)
+{
+    // Events arrive in commit order; consecutive events with one txId form a
+    // transaction, and txId 0 marks an event that is its own transaction
+    for (auto& ev : events) {
+        if (txns_.empty() || ev.txId == 0 || txns_.back().txId != ev.txId) {
+            txns_.push_back(SourceTransaction{ ev.txId, {}, {} });
+        }
+        txns_.back().events.push_back(std::move(ev));
+    }
+
+    // Keyed by row hash: a collision only adds a spurious dependency, which is safe
+    std::unordered_map<size_t, size_t> lastWriter;
+    for (size_t i = 0; i < txns_.size(); ++i) {
+        auto& deps = txns_[i].dependsOn;
+        for (const auto& ev : txns_[i].events) {
+            const size_t rowKey = ev.rowHash();
+            auto it = lastWriter.find(rowKey);
+            if (it != lastWriter.end() && it->second != i &&
+                std::find(deps.begin(), deps.end(), it->second) == deps.end()) {
+                deps.push_back(it->second);
+            }
+            lastWriter[rowKey] = i;
+        }
+    }
+    done_.assign(txns_.size(), false);
+    heldBack_.assign(txns_.size(), false);
+}
+
+size_t TransactionScheduler::size() const
+{
+    return txns_.size();
+}
+
+const SourceTransaction& TransactionScheduler::transaction(size_t index) const
+{
+    return txns_[index];
+}
+
+std::vector<size_t> TransactionScheduler::assign(size_t nWorkers) const
+{
+    std::vector<size_t> worker(txns_.size(), 0);
+    std::vector<size_t> load(nWorkers, 0);
+    for (size_t i = 0; i < txns_.size(); ++i) {
+        const auto& deps = txns_[i].dependsOn;
+        bool sameWorker = !deps.empty();
+        for (size_t d : deps) {
+            if (worker[d] != worker[deps.front()]) { sameWorker = false; break; }
+        }
+        worker[i] = sameWorker
+            ? worker[deps.front()]
+            : static_cast<size_t>(std::min_element(load.begin(), load.end()) - load.begin());
+        load[worker[i]] += txns_[i].events.size();
+    }
+    return worker;
+}
+
+bool TransactionScheduler::waitForDependencies(size_t index)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&] {
+        for (size_t d : txns_[index].dependsOn) {
+            if (!done_[d]) return false;
+        }
+        return true;
+    });
+    for (size_t d : txns_[index].dependsOn) {
+        if (heldBack_[d]) return false;
+    }
+    return true;
+}
+
+void TransactionScheduler::markDone(size_t index, bool heldBack)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_[index] = true;
+        heldBack_[index] = heldBack;
+        while (firstPending_ < txns_.size() && done_[firstPending_]) ++firstPending_;
+    }
+    cv_.notify_all();
+}
+
+std::uint64_t TransactionScheduler::oldestPendingLsn(size_t index)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    // In commit order, so the first pending one with a position is the oldest
+    for (size_t i = firstPending_; i < txns_.size(); ++i) {
+        if (i == index || done_[i]) continue;
+        for (const auto& ev : txns_[i].events) {
+            if (ev.lsn != 0) return ev.lsn;
+        }
+    }
+    return UINT64_MAX;
+}
+
+} // namespace SyncLayer::Queue
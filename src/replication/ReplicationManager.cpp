@@ -5,129 +5,179 @@
 #include "tracker/TableTracker.hpp"
 #include "queue/QueueHandler.hpp"
 #include "utils/Retry.hpp"
+#include "db/BulkUpsert.hpp"
+#include "db/Async.hpp"
 #include <spdlog/spdlog.h>
-#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <thread>
 
 namespace SyncLayer::Replication {
 
+// Checks one database answers and reads its metrics; the query doubles as the reachability check.
+static SyncLayer::DB::Task<bool> probeDatabase(SyncLayer::DB::AsyncConnection db, const char* label, long& connections,
+                                               long& sizeMB, long& activeQueries)
+{
+    const auto stats = co_await db.query(
+        "SELECT count(*) AS connections, count(*) FILTER (WHERE state = 'active') AS active, "
+        "pg_database_size(current_database()) / 1024 / 1024 AS size_mb "
+        "FROM pg_stat_activity WHERE datname = current_database()");
+    if (stats.status() != PGRES_TUPLES_OK || stats.rows() == 0) {
+        spdlog::error("{} DB health check failed: {}", label, stats.error());
+        co_return false;
+    }
+    connections = stats.get<long>(0, "connections");
+    activeQueries = stats.get<long>(0, "active");
+    sizeMB = stats.get<long>(0, "size_mb");
+    co_return true;
+}
+
+static SyncLayer::DB::Task<SyncLayer::DB::Result> fetchPage(SyncLayer::DB::AsyncConnection source, std::string sql)
+{
+    co_return co_await source.query(std::move(sql));
+}
+
+// Opens the read-only repeatable-read transaction the initial sync reads in,
+// rolling back an aborted one first; false if the source can't be used.
+static bool beginSnapshot(SyncLayer::DB::DBConnection* source)
+{
+    if (!source->ensureConnected()) {
+        spdlog::error("Could not reconnect to the source for the initial sync");
+        return false;
+    }
+    if (PQtransactionStatus(source->raw()) != PQTRANS_IDLE) SyncLayer::DB::Result(PQexec(source->raw(), "ROLLBACK"));
+    const SyncLayer::DB::Result begun(PQexec(source->raw(), "BEGIN ISOLATION LEVEL REPEATABLE READ READ ONLY"));
+    if (begun.status() == PGRES_COMMAND_OK) return true;
+    spdlog::error("Failed to open a snapshot on the source: {}", begun.error());
+    return false;
+}
+
 ReplicationManager::ReplicationManager(std::shared_ptr<SyncLayer::Config::Config> config,
                                        std::shared_ptr<SyncLayer::Logging::Logger> logger)
     : config_(std::move(config)), logger_(std::move(logger)), initialSyncDone_(false)
 {
-    local_ = std::make_unique<SyncLayer::DB::DBConnection>(config_->getLocalConnString());
-    hosted_ = std::make_unique<SyncLayer::DB::DBConnection>(config_->getHostedConnString());
+    using SyncLayer::DB::ConnectionPool;
+    using SyncLayer::DB::Role;
+    const auto& sizes = config_->getPools();
+    const std::chrono::seconds ping(config_->getPoolPingSeconds());
+    // Capture only reads the source and apply only writes the target
+    auto localSizes = sizes;
+    localSizes.erase("apply");
+    auto hostedSizes = sizes;
+    hostedSizes.erase("capture");
+    // Every apply worker holds a connection, plus the one drains run on; all of them are needed at start
+    auto& apply = hostedSizes["apply"];
+    apply.max = std::max(apply.max, std::max(config_->getApplyWorkers(), 1) + 1);
+    apply.min = apply.max;
+    localPool_ = std::make_unique<ConnectionPool>("local", config_->getLocalConnString(), localSizes, ping);
+    hostedPool_ = std::make_unique<ConnectionPool>("hosted", config_->getHostedConnString(), hostedSizes, ping);
+    // Server-side bounds on every hosted statement; the apply watchdog covers waits the server can't see
+    if (config_->getStatementTimeoutMs() > 0) {
+        hostedPool_->setSessionParameter("statement_timeout", std::to_string(config_->getStatementTimeoutMs()));
+    }
+    if (config_->getLockTimeoutMs() > 0) {
+        hostedPool_->setSessionParameter("lock_timeout", std::to_string(config_->getLockTimeoutMs()));
+    }
+    // Both databases at once, so startup waits on the slowest handshake rather than the sum of them
+    ConnectionPool::warmUp({ localPool_.get(), hostedPool_.get() });
+    local_ = localPool_->acquire(Role::Capture);
+    hosted_ = hostedPool_->acquire(Role::Apply);
     tracker_ = std::make_unique<SyncLayer::Tracker::TableTracker>(local_.get(), config_);
-    queue_ = std::make_unique<SyncLayer::Queue::QueueHandler>();
+    queue_ = std::make_unique<SyncLayer::Queue::QueueHandler>(config_, tracker_.get(), *hostedPool_);
 }
 
 void ReplicationManager::initialSync()
 {
+    using SyncLayer::DB::Result;
     const auto& tables = tracker_->getTrackedTables();
     spdlog::info("Starting initial data sync for {} tables", tables.size());
-    const int pageSize = 1000;
-    const int batchSize = 100; // Batch inserts
-    for (const auto& table : tables) {
+    const int fetchRows = config_->getSnapshotFetchRows();
+    auto source = localPool_->acquire(SyncLayer::DB::Role::Copy);
+    auto target = hostedPool_->acquire(SyncLayer::DB::Role::Copy);
+    // Every table is read from the same snapshot, each through a cursor that scans it once
+    if (!beginSnapshot(source.get())) return;
+    SyncLayer::DB::EventLoop loop;
+    const SyncLayer::DB::AsyncConnection reader(loop, source.get());
+    for (size_t t = 0; t < tables.size(); ++t) {
+        const auto& table = tables[t];
         const auto& pk = tracker_->getPrimaryKeys(table);
         if (pk.empty()) {
             spdlog::warn("Skipping table {} due to no primary key", table);
             continue;
         }
         spdlog::info("Syncing data for table: {}", table);
-        
-        std::string orderBy = " ORDER BY ";
-        for (size_t i = 0; i < pk.size(); ++i) {
-            if (i > 0) orderBy += ", ";
-            orderBy += "\"" + pk[i] + "\"";
+        const auto& columns = tracker_->getColumns(table);
+
+        // One prepared unnest() statement per table covers every page size
+        SyncLayer::DB::BulkUpsert upsert(table, columns, tracker_->getColumnTypes(table),
+                                         tracker_->getColumnTypeNames(table), pk, false);
+        const std::string statement = "synclayer_sync_" + std::to_string(t);
+        // Registered on the connection, so a reconnect mid-copy prepares it again
+        if (!target->prepare(statement, upsert.sql(), upsert.paramCount())) {
+            spdlog::error("Failed to prepare bulk insert for {}: {}", table, PQerrorMessage(target->raw()));
+            continue;
         }
-        
-        int offset = 0;
+
+        std::string selectList;
+        for (size_t i = 0; i < columns.size(); ++i) {
+            if (i > 0) selectList += ", ";
+            selectList += "\"" + columns[i] + "\"";
+        }
+        // Unordered: rows come back in scan order, and the upsert doesn't care which page a key lands in
+        const std::string cursor = "synclayer_snapshot_" + std::to_string(t);
+        const std::string declare = "DECLARE " + cursor + " NO SCROLL CURSOR FOR SELECT " + selectList + " FROM " + table;
+        const Result declared(PQexec(source->raw(), declare.c_str()));
+        if (declared.status() != PGRES_COMMAND_OK) {
+            spdlog::error("Failed to open a cursor on {}: {}", table, declared.error());
+            // The failed statement aborted the snapshot; carry on with the next table in a new one
+            if (!beginSnapshot(source.get())) return;
+            continue;
+        }
+
+        const std::string fetch = "FETCH FORWARD " + std::to_string(fetchRows) + " FROM " + cursor;
+        auto fetchAhead = [&reader, &fetch] {
+            auto page = fetchPage(reader, fetch);
+            page.start(); // sends the FETCH; the loop collects the rows
+            return page;
+        };
+        auto pending = fetchAhead();
         int totalRows = 0;
+        bool failed = false;
         while (true) {
-            std::string query = "SELECT * FROM " + table + orderBy + " LIMIT " + std::to_string(pageSize) + " OFFSET " + std::to_string(offset);
-            PGresult* res = executeWithRetry(local_->raw(), query);
-            if (!res || PQresultStatus(res) != PGRES_TUPLES_OK) {
-                spdlog::error("Failed to select from {}: {}", table, res ? PQerrorMessage(local_->raw()) : "No result");
-                if (res) PQclear(res);
+            loop.run();
+            const Result page = std::move(pending.result());
+            if (page.status() != PGRES_TUPLES_OK) {
+                spdlog::error("Failed to fetch from {}: {}", table, page.error());
+                failed = true;
                 break;
             }
-            
-            int nRows = PQntuples(res);
-            if (nRows == 0) {
-                PQclear(res);
-                break;
-            }
-            
-            int nFields = PQnfields(res);
-            std::vector<std::string> inserts;
-            for (int i = 0; i < nRows; ++i) {
-                std::string values = "(";
-                for (int j = 0; j < nFields; ++j) {
-                    if (j > 0) values += ",";
-                    if (PQgetisnull(res, i, j)) {
-                        values += "NULL";
-                    } else {
-                        const char* val = PQgetvalue(res, i, j);
-                        char* escaped = PQescapeLiteral(hosted_->raw(), val, strlen(val));
-                        if (escaped) {
-                            values += escaped;
-                            PQfreemem(escaped);
-                        } else {
-                            values += "NULL";
-                        }
-                    }
-                }
-                values += ")";
-                inserts.push_back(values);
-                
-                if (inserts.size() >= batchSize) {
-                    std::string insertQuery = "INSERT INTO " + table + " (";
-                    for (int j = 0; j < nFields; ++j) {
-                        if (j > 0) insertQuery += ",";
-                        insertQuery += "\"" + std::string(PQfname(res, j)) + "\"";
-                    }
-                    insertQuery += ") VALUES ";
-                    for (size_t k = 0; k < inserts.size(); ++k) {
-                        if (k > 0) insertQuery += ",";
-                        insertQuery += inserts[k];
-                    }
-                    insertQuery += " ON CONFLICT DO NOTHING";
-                    
-                    PGresult* insRes = executeWithRetry(hosted_->raw(), insertQuery);
-                    if (!insRes || PQresultStatus(insRes) != PGRES_COMMAND_OK) {
-                        spdlog::error("Failed to batch insert into {}: {}", table, insRes ? PQerrorMessage(hosted_->raw()) : "No result");
-                    }
-                    if (insRes) PQclear(insRes);
-                    inserts.clear();
-                }
-            }
-            // Insert remaining
-            if (!inserts.empty()) {
-                std::string insertQuery = "INSERT INTO " + table + " (";
-                for (int j = 0; j < nFields; ++j) {
-                    if (j > 0) insertQuery += ",";
-                    insertQuery += "\"" + std::string(PQfname(res, j)) + "\"";
-                }
-                insertQuery += ") VALUES ";
-                for (size_t k = 0; k < inserts.size(); ++k) {
-                    if (k > 0) insertQuery += ",";
-                    insertQuery += inserts[k];
-                }
-                insertQuery += " ON CONFLICT DO NOTHING";
-                
-                PGresult* insRes = executeWithRetry(hosted_->raw(), insertQuery);
-                if (!insRes || PQresultStatus(insRes) != PGRES_COMMAND_OK) {
-                    spdlog::error("Failed to batch insert into {}: {}", table, insRes ? PQerrorMessage(hosted_->raw()) : "No result");
-                }
-                if (insRes) PQclear(insRes);
+            const int nRows = page.rows();
+            if (nRows == 0) break;
+            // A full page may have more behind it: the source reads that while this one is written
+            const bool more = nRows == fetchRows;
+            if (more) pending = fetchAhead();
+
+            // Values are encoded straight out of the result's tuple storage
+            upsert.bind(nRows, [&page](int row, int column) { return page.value(row, column); });
+            const auto inserted = executePreparedWithRetry(target.get(), hostedPool_->breaker(), statement,
+                                                           upsert.paramCount(), upsert.values(), upsert.lengths(),
+                                                           upsert.formats());
+            if (inserted.status() != PGRES_COMMAND_OK) {
+                spdlog::error("Failed to batch insert into {}: {}", table, inserted.error());
             }
-            
-            PQclear(res);
+
             totalRows += nRows;
-            offset += pageSize;
-            spdlog::info("Synced {} rows for table {} (offset {})", nRows, table, offset);
+            spdlog::info("Synced {} rows for table {} ({} so far)", nRows, table, totalRows);
+            if (!more) break;
+        }
+        if (failed) {
+            if (!beginSnapshot(source.get())) return;
+            continue;
         }
+        Result(PQexec(source->raw(), ("CLOSE " + cursor).c_str()));
         spdlog::info("Completed syncing {} rows for table {}", totalRows, table);
     }
+    Result(PQexec(source->raw(), "COMMIT"));
     spdlog::info("Initial data sync completed");
 }
 
@@ -142,21 +192,89 @@ void ReplicationManager::start()
         return;
     }
     
+    // A failover or network blip leaves these dead; reconnect before using them.
+    // A database whose breaker is open isn't dialed again until its cooldown is over.
+    auto reconnect = [](SyncLayer::DB::DBConnection& db, SyncLayer::Utils::CircuitBreaker& breaker) {
+        if (PQstatus(db.raw()) == CONNECTION_OK) return true;
+        if (!breaker.allow()) {
+            spdlog::warn("Not reconnecting to the {}: circuit open", breaker.name());
+            return false;
+        }
+        const bool up = db.ensureConnected();
+        if (up) {
+            breaker.recordSuccess();
+        } else {
+            breaker.recordFailure();
+        }
+        return up;
+    };
+    if (!reconnect(*local_.get(), localPool_->breaker()) || !reconnect(*hosted_.get(), hostedPool_->breaker())) {
+        spdlog::error("Could not reconnect to the databases. Skipping this cycle.");
+        return;
+    }
+
     // Discover tables first
     tracker_->discoverTables();
     
-    // Perform initial data sync only once
+    // Perform initial data sync only once, and not at all when the target
+    // already records progress: capture resumes from there instead
     if (!initialSyncDone_) {
-        initialSync();
+        std::uint64_t resumeAt = queue_->loadProgress(hosted_.get());
+        if (resumeAt > 0) {
+            tracker_->resumeFrom(resumeAt);
+        } else {
+            initialSync();
+        }
         initialSyncDone_ = true;
     }
     
-    // Then fetch changes
-    auto changes = tracker_->fetchChanges(config_->getBatchSize());
-    for (const auto& change : changes) {
-        queue_->enqueue(change);
+    // Backpressure: capture does not read (or acknowledge) more source changes
+    // while the queue is over its memory budget; a slow target shows up as lag
+    if (queue_->overBudget()) {
+        spdlog::warn("Queue over memory budget ({} MB queued, apply lag {} ms); pausing capture",
+                     queue_->queuedBytes() / (1024 * 1024), queue_->applyLag().count());
+        queue_->drainTo(hosted_.get());
     }
+
+    // Then read changes until the source is caught up, handing each fetch to
+    // the queue whole. Apply runs whenever a micro-batch trigger fires rather
+    // than once per fetch, so bursts apply in large batches and a trickle
+    // still goes out within apply_max_wait_ms.
+    // A cycle keeps reading while fetches come back full, but no longer than
+    // one interval: a source that never runs dry mustn't keep it from returning
+    const int batchSize = config_->getBatchSize();
+    const auto budget = std::chrono::seconds(std::max(config_->getIntervalSeconds(), 1));
+    const auto cycleStart = std::chrono::steady_clock::now();
+    size_t fetched = 0;
+    do {
+        if (stopping_.load(std::memory_order_relaxed)) {
+            spdlog::info("Stop requested; ending the capture cycle");
+            break;
+        }
+        auto changes = tracker_->fetchChanges(batchSize);
+        fetched = changes.size();
+        auto pending = queue_->enqueueBatch(std::move(changes));
+        while (!pending.empty()) {
+            // Queue is full: apply what is there to make room
+            spdlog::warn("Queue full ({} MB queued, apply lag {} ms); pausing capture until apply catches up",
+                         queue_->queuedBytes() / (1024 * 1024), queue_->applyLag().count());
+            queue_->drainTo(hosted_.get());
+            pending = queue_->enqueueBatch(std::move(pending));
+        }
+        if (queue_->flushDue()) queue_->drainTo(hosted_.get());
+    } while (fetched > 0 && fetched == static_cast<size_t>(batchSize) &&
+             std::chrono::steady_clock::now() - cycleStart < budget);
+
+    // Caught up: nothing else arrives before the next cycle, so flush the remainder
     queue_->drainTo(hosted_.get());
+
+    // Parked lanes and held transactions would otherwise wait a whole interval for
+    // their retry; drain again as each comes due. Sleeps are short enough for stop() to cut in.
+    while (queue_->holding() && !stopping_.load(std::memory_order_relaxed)) {
+        const auto wake = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        std::this_thread::sleep_until(std::min(queue_->nextRetry(), wake));
+        if (queue_->nextRetry() <= std::chrono::steady_clock::now()) queue_->drainTo(hosted_.get());
+    }
 }
 
 HealthStatus ReplicationManager::healthCheck() {
@@ -171,66 +289,37 @@ HealthStatus ReplicationManager::healthCheck() {
     status.hostedDbSizeMB = 0;
     status.localActiveQueries = 0;
     status.hostedActiveQueries = 0;
-    
-    // Check local DB
-    PGresult* res = PQexec(local_->raw(), "SELECT 1");
-    if (PQresultStatus(res) == PGRES_TUPLES_OK) {
-        status.localDb = true;
-        
-        // Get connections
-        PQclear(res);
-        res = PQexec(local_->raw(), "SELECT count(*) FROM pg_stat_activity WHERE datname = current_database()");
-        if (PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) > 0) {
-            status.localConnections = atol(PQgetvalue(res, 0, 0));
-        }
-        
-        // Get DB size
-        PQclear(res);
-        res = PQexec(local_->raw(), "SELECT pg_database_size(current_database()) / 1024 / 1024");
-        if (PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) > 0) {
-            status.localDbSizeMB = atol(PQgetvalue(res, 0, 0));
-        }
-        
-        // Get active queries
-        PQclear(res);
-        res = PQexec(local_->raw(), "SELECT count(*) FROM pg_stat_activity WHERE state = 'active' AND datname = current_database()");
-        if (PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) > 0) {
-            status.localActiveQueries = atol(PQgetvalue(res, 0, 0));
+    status.skippedEvents = queue_->skippedEvents();
+
+    // Probes lease their own connections: the health endpoint calls this from its server thread
+    auto monitor = [](SyncLayer::DB::ConnectionPool& pool) {
+        try {
+            return pool.acquire(SyncLayer::DB::Role::Monitoring, std::chrono::seconds(5));
+        } catch (const std::exception& e) {
+            spdlog::error("No {} DB connection for health check: {}", pool.name(), e.what());
+            return SyncLayer::DB::ConnectionPool::Lease();
         }
-    } else {
-        spdlog::error("Local DB health check failed: {}", PQerrorMessage(local_->raw()));
-    }
-    PQclear(res);
+    };
+    auto local = monitor(*localPool_);
+    auto hosted = monitor(*hostedPool_);
     
-    // Check hosted DB
-    res = PQexec(hosted_->raw(), "SELECT 1");
-    if (PQresultStatus(res) == PGRES_TUPLES_OK) {
-        status.hostedDb = true;
-        
-        // Get connections
-        PQclear(res);
-        res = PQexec(hosted_->raw(), "SELECT count(*) FROM pg_stat_activity WHERE datname = current_database()");
-        if (PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) > 0) {
-            status.hostedConnections = atol(PQgetvalue(res, 0, 0));
-        }
-        
-        // Get DB size
-        PQclear(res);
-        res = PQexec(hosted_->raw(), "SELECT pg_database_size(current_database()) / 1024 / 1024");
-        if (PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) > 0) {
-            status.hostedDbSizeMB = atol(PQgetvalue(res, 0, 0));
-        }
-        
-        // Get active queries
-        PQclear(res);
-        res = PQexec(hosted_->raw(), "SELECT count(*) FROM pg_stat_activity WHERE state = 'active' AND datname = current_database()");
-        if (PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) > 0) {
-            status.hostedActiveQueries = atol(PQgetvalue(res, 0, 0));
-        }
-    } else {
-        spdlog::error("Hosted DB health check failed: {}", PQerrorMessage(hosted_->raw()));
+    // Both databases are probed at once; a slow one costs its own latency, not the sum
+    SyncLayer::DB::EventLoop loop;
+    std::vector<std::pair<bool*, SyncLayer::DB::Task<bool>>> probes;
+    if (local) {
+        probes.emplace_back(&status.localDb, probeDatabase({ loop, local.get() }, "Local", status.localConnections,
+                                                           status.localDbSizeMB, status.localActiveQueries));
+    }
+    if (hosted) {
+        probes.emplace_back(&status.hostedDb, probeDatabase({ loop, hosted.get() }, "Hosted", status.hostedConnections,
+                                                            status.hostedDbSizeMB, status.hostedActiveQueries));
     }
-    PQclear(res);
+    for (auto& [up, probe] : probes) probe.start();
+    if (!loop.run(std::chrono::seconds(10))) {
+        // A probe still in flight leaves its connection busy, so the pool closes it on return
+        spdlog::error("Health check timed out waiting for {} database(s)", loop.watched());
+    }
+    for (auto& [up, probe] : probes) *up = probe.done() && probe.result();
     
     status.overall = status.localDb && status.hostedDb;
     if (status.overall) {
@@ -241,19 +330,41 @@ HealthStatus ReplicationManager::healthCheck() {
     return status;
 }
 
-PGresult* ReplicationManager::executeWithRetry(PGconn* conn, const std::string& query, int maxAttempts) {
-    PGresult* res = nullptr;
-    SyncLayer::Utils::Retry::withExponentialBackoff(maxAttempts, [&](int attempt) {
-        res = PQexec(conn, query.c_str());
-        if (PQresultStatus(res) == PGRES_COMMAND_OK || PQresultStatus(res) == PGRES_TUPLES_OK) {
-            return true; // success
-        } else {
-            spdlog::warn("Query failed on attempt {}: {}", attempt, PQerrorMessage(conn));
-            PQclear(res);
-            res = nullptr;
-            return false; // retry
-        }
+// Failures the next attempt might not repeat are worth another try; anything else is final
+static SyncLayer::Utils::Retry::Outcome classify(const SyncLayer::DB::Result& res, int attempt)
+{
+    using Outcome = SyncLayer::Utils::Retry::Outcome;
+    if (res.ok()) return Outcome::Succeeded;
+    const bool transient = res.transient();
+    const std::string_view state = res.sqlstate().empty() ? "none" : res.sqlstate();
+    spdlog::warn("Query failed on attempt {} (SQLSTATE {}{}): {}", attempt, state, transient ? "" : ", not retrying",
+                 res.error());
+    if (res.unavailable()) return Outcome::Unavailable;
+    return transient ? Outcome::Transient : Outcome::Permanent;
+}
+
+static SyncLayer::Utils::Retry::Policy retryPolicy(SyncLayer::Utils::CircuitBreaker& breaker, int maxAttempts)
+{
+    SyncLayer::Utils::Retry::Policy policy;
+    policy.maxAttempts = maxAttempts;
+    policy.breaker = &breaker;
+    return policy;
+}
+
+SyncLayer::DB::Result ReplicationManager::executePreparedWithRetry(SyncLayer::DB::DBConnection* db,
+                                                                 SyncLayer::Utils::CircuitBreaker& breaker,
+                                                                 const std::string& statement, int nParams,
+                                                                 const char* const* values, const int* lengths,
+                                                                 const int* formats, int maxAttempts) {
+    using Outcome = SyncLayer::Utils::Retry::Outcome;
+    SyncLayer::DB::Result res;
+    const auto outcome = SyncLayer::Utils::Retry::run(retryPolicy(breaker, maxAttempts), [&](int attempt) {
+        // Retrying on a dead connection can't succeed; reconnect first
+        if (!db->ensureConnected()) return Outcome::Unavailable;
+        res = SyncLayer::DB::Result(PQexecPrepared(db->raw(), statement.c_str(), nParams, values, lengths, formats, 0));
+        return classify(res, attempt);
     });
+    if (outcome == Outcome::Rejected) spdlog::warn("Not running {} on the {}: circuit open", statement, breaker.name());
     return res;
 }
 
@@ -0,0 +1,102 @@
+#include "tracker/ChangeEvent.hpp"
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace SyncLayer::Tracker {
+
+namespace {
+
+struct Names {
+    std::shared_mutex mutex;
+    std::deque<std::string> byId; // deque keeps elements in place, so the map can key on views of them
+    std::unordered_map<std::string_view, TableId> ids;
+};
+
+Names& names()
+{
+    static Names instance;
+    return instance;
+}
+
+} // namespace
+
+const char* opName(Op op)
+{
+    switch (op) {
+    case Op::Insert: return "insert";
+    case Op::Update: return "update";
+    case Op::Delete: return "delete";
+    }
+    return "unknown";
+}
+
+TableId TableRegistry::intern(std::string_view name)
+{
+    Names& n = names();
+    {
+        std::shared_lock<std::shared_mutex> lock(n.mutex);
+        auto it = n.ids.find(name);
+        if (it != n.ids.end()) return it->second;
+    }
+    std::unique_lock<std::shared_mutex> lock(n.mutex);
+    auto it = n.ids.find(name);
+    if (it != n.ids.end()) return it->second;
+    const TableId id = static_cast<TableId>(n.byId.size());
+    n.byId.emplace_back(name);
+    n.ids.emplace(n.byId.back(), id);
+    return id;
+}
+
+const std::string& TableRegistry::name(TableId id)
+{
+    Names& n = names();
+    std::shared_lock<std::shared_mutex> lock(n.mutex);
+    return n.byId.at(id);
+}
+
+std::string_view ColumnPayload::pack(SyncLayer::Utils::Arena& arena, const char* const* values, const int* lengths, int n)
+{
+    size_t size = 0;
+    for (int i = 0; i < n; ++i) {
+        size += 4 + (values[i] ? static_cast<size_t>(lengths[i]) + 1 : 0);
+    }
+    char* out = arena.allocate(size);
+    char* p = out;
+    for (int i = 0; i < n; ++i) {
+        const std::int32_t len = values[i] ? lengths[i] : -1;
+        std::memcpy(p, &len, 4);
+        p += 4;
+        if (!values[i]) continue;
+        std::memcpy(p, values[i], static_cast<size_t>(len));
+        p += len;
+        *p++ = '\0';
+    }
+    return std::string_view(out, size);
+}
+
+bool ColumnPayload::unpack(std::string_view payload, std::vector<const char*>& values, std::vector<int>& lengths)
+{
+    const char* p = payload.data();
+    const char* end = p + payload.size();
+    while (p < end) {
+        std::int32_t len;
+        if (end - p < 4) return false;
+        std::memcpy(&len, p, 4);
+        p += 4;
+        if (len < 0) {
+            values.push_back(nullptr);
+            lengths.push_back(0);
+            continue;
+        }
+        if (end - p < static_cast<std::ptrdiff_t>(len) + 1) return false;
+        values.push_back(p);
+        lengths.push_back(len);
+        p += len + 1;
+    }
+    return true;
+}
+
+} // namespace SyncLayer::Tracker
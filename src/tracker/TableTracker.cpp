@@ -12,6 +12,9 @@ void TableTracker::discoverTables()
 {
     trackedTables_.clear();
     tablePrimaryKeys_.clear();
+    tableColumns_.clear();
+    tableColumnTypes_.clear();
+    tableColumnTypeNames_.clear();
     if (config_->getAutoFetch()) {
         // Discover all user tables in public schema
         PGresult* res = PQexec(local_->raw(), "SELECT table_name FROM information_schema.tables WHERE table_schema = 'public' AND table_type = 'BASE TABLE'");
@@ -54,6 +57,30 @@ void TableTracker::discoverTables()
             spdlog::error("Failed to get primary key for {}: {}", table, PQerrorMessage(local_->raw()));
         }
         PQclear(pkRes);
+
+        // Column names feed the apply upserts; type OIDs pick the binary parameter
+        // encoders and type names are used for parameter casts
+        std::string colQuery = "SELECT attname, atttypid, format_type(atttypid, atttypmod) FROM pg_attribute "
+                               "WHERE attrelid = '" + table + "'::regclass AND attnum > 0 AND NOT attisdropped "
+                               "ORDER BY attnum";
+        PGresult* colRes = PQexec(local_->raw(), colQuery.c_str());
+        if (PQresultStatus(colRes) == PGRES_TUPLES_OK) {
+            int nColRows = PQntuples(colRes);
+            std::vector<std::string> columns;
+            std::vector<Oid> types;
+            std::vector<std::string> typeNames;
+            for (int i = 0; i < nColRows; ++i) {
+                columns.push_back(PQgetvalue(colRes, i, 0));
+                types.push_back(static_cast<Oid>(std::stoul(PQgetvalue(colRes, i, 1))));
+                typeNames.push_back(PQgetvalue(colRes, i, 2));
+            }
+            tableColumns_[table] = columns;
+            tableColumnTypes_[table] = types;
+            tableColumnTypeNames_[table] = typeNames;
+        } else {
+            spdlog::error("Failed to get columns for {}: {}", table, PQerrorMessage(local_->raw()));
+        }
+        PQclear(colRes);
     }
 
     std::string joinedTables;
@@ -70,12 +97,54 @@ std::vector<ChangeEvent> TableTracker::fetchChanges(int batchSize)
 {
     // Placeholder stub: in production, use logical decoding or triggers
     std::vector<ChangeEvent> events;
+    const std::string table = trackedTables_.empty() ? "public.sample" : trackedTables_.front();
+    const auto& columns = getColumns(table);
+    const auto& pk = getPrimaryKeys(table);
+    // The batch shares one arena for its keys and row images
+    auto arena = std::make_shared<SyncLayer::Utils::Arena>();
+    std::vector<const char*> values(columns.size(), nullptr);
+    std::vector<int> lengths(columns.size(), 0);
+    for (size_t j = 0; j < columns.size(); ++j) {
+        if (!pk.empty() && columns[j] == pk.front()) {
+            values[j] = "1";
+            lengths[j] = 1;
+        }
+    }
     for (int i = 0; i < batchSize && i < 3; ++i) {
-        events.push_back( ChangeEvent{ trackedTables_.empty() ? "public.sample" : trackedTables_.front(), "insert", "{\"id\":1}" } );
+        ++lastLsn_;
+        ChangeEvent ev;
+        ev.table = TableRegistry::intern(table);
+        ev.op = Op::Insert;
+        ev.txId = lastLsn_;
+        ev.lsn = lastLsn_;
+        ev.key = arena->copy("1");
+        ev.payload = ColumnPayload::pack(*arena, values.data(), lengths.data(), static_cast<int>(values.size()));
+        ev.arena = arena;
+        events.push_back(std::move(ev));
     }
     return events;
 }
 
+const std::vector<Oid>& TableTracker::getColumnTypes(const std::string& table) const
+{
+    static const std::vector<Oid> empty;
+    auto it = tableColumnTypes_.find(table);
+    return it != tableColumnTypes_.end() ? it->second : empty;
+}
+
+const std::vector<std::string>& TableTracker::getColumnTypeNames(const std::string& table) const
+{
+    static const std::vector<std::string> empty;
+    auto it = tableColumnTypeNames_.find(table);
+    return it != tableColumnTypeNames_.end() ? it->second : empty;
+}
+
+void TableTracker::resumeFrom(std::uint64_t lsn)
+{
+    lastLsn_ = lsn;
+    spdlog::info("Resuming capture after source position {}", lsn);
+}
+
 const std::vector<std::string>& TableTracker::getTrackedTables() const
 {
     return trackedTables_;
@@ -88,6 +157,13 @@ const std::vector<std::string>& TableTracker::getPrimaryKeys(const std::string&
     return it != tablePrimaryKeys_.end() ? it->second : empty;
 }
 
+const std::vector<std::string>& TableTracker::getColumns(const std::string& table) const
+{
+    static const std::vector<std::string> empty;
+    auto it = tableColumns_.find(table);
+    return it != tableColumns_.end() ? it->second : empty;
+}
+
 } // namespace SyncLayer::Tracker
 
 
@@ -0,0 +1,42 @@
+#include "utils/Arena.hpp"
+#include <cstring>
+
+namespace SyncLayer::Utils {
+
+Arena::Arena(size_t blockSize)
+    : blockSize_(blockSize) {}
+
+char* Arena::allocate(size_t n)
+{
+    if (n > left_) {
+        // Large requests get their own block so the current one keeps its free space
+        if (n > blockSize_ / 4) {
+            blocks_.push_back(std::make_unique<char[]>(n));
+            capacity_ += n;
+            return blocks_.back().get();
+        }
+        blocks_.push_back(std::make_unique<char[]>(blockSize_));
+        capacity_ += blockSize_;
+        cursor_ = blocks_.back().get();
+        left_ = blockSize_;
+    }
+    char* p = cursor_;
+    cursor_ += n;
+    left_ -= n;
+    return p;
+}
+
+std::string_view Arena::copy(std::string_view bytes)
+{
+    if (bytes.empty()) return {};
+    char* p = allocate(bytes.size());
+    std::memcpy(p, bytes.data(), bytes.size());
+    return std::string_view(p, bytes.size());
+}
+
+size_t Arena::capacity() const
+{
+    return capacity_;
+}
+
+} // namespace SyncLayer::Utils
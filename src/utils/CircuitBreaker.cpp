@@ -0,0 +1,56 @@
+#include "utils/CircuitBreaker.hpp"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+
+namespace SyncLayer::Utils {
+
+CircuitBreaker::CircuitBreaker(std::string name, int failureThreshold, std::chrono::milliseconds cooldown)
+    : name_(std::move(name)), failureThreshold_(std::max(1, failureThreshold)), cooldown_(cooldown)
+{
+}
+
+bool CircuitBreaker::allow()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ == State::Closed) return true;
+    if (state_ == State::Open) {
+        if (Clock::now() - openedAt_ < cooldown_) return false;
+        state_ = State::HalfOpen;
+        probing_ = false;
+    }
+    // Half-open: a single trial call at a time
+    if (probing_) return false;
+    probing_ = true;
+    return true;
+}
+
+void CircuitBreaker::recordSuccess()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != State::Closed) spdlog::info("{} is answering again; circuit closed", name_);
+    state_ = State::Closed;
+    failures_ = 0;
+    probing_ = false;
+}
+
+void CircuitBreaker::recordFailure()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++failures_;
+    if (state_ == State::HalfOpen || (state_ == State::Closed && failures_ >= failureThreshold_)) {
+        if (state_ == State::Closed) {
+            spdlog::warn("{} failed {} times in a row; circuit open for {} ms", name_, failures_, cooldown_.count());
+        }
+        state_ = State::Open;
+        openedAt_ = Clock::now();
+        probing_ = false;
+    }
+}
+
+CircuitBreaker::State CircuitBreaker::state() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return state_;
+}
+
+} // namespace SyncLayer::Utils
@@ -0,0 +1,30 @@
+#include "utils/Crc32.hpp"
+#include <array>
+
+namespace SyncLayer::Utils {
+
+static std::array<std::uint32_t, 256> makeTable()
+{
+    std::array<std::uint32_t, 256> table {};
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        std::uint32_t c = i;
+        for (int k = 0; k < 8; ++k) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+    }
+    return table;
+}
+
+std::uint32_t Crc32::compute(const void* data, size_t len, std::uint32_t crc)
+{
+    static const std::array<std::uint32_t, 256> table = makeTable();
+    const auto* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i) {
+        crc = table[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+} // namespace SyncLayer::Utils
@@ -1,20 +1,48 @@
 #include "utils/Retry.hpp"
+#include "utils/CircuitBreaker.hpp"
+#include <algorithm>
+#include <random>
 #include <thread>
 
 namespace SyncLayer::Utils {
 
-void Retry::withExponentialBackoff(int maxAttempts, std::function<bool(int)> attemptFn)
+std::chrono::milliseconds Retry::nextDelay(std::chrono::milliseconds previous, std::chrono::milliseconds base,
+                                           std::chrono::milliseconds cap)
 {
-    int attempt = 0;
-    std::chrono::milliseconds delay(100);
-    while (attempt < maxAttempts) {
-        if (attemptFn(attempt + 1)) return;
+    thread_local std::mt19937_64 rng(std::random_device{}());
+    const auto high = std::max(base.count(), previous.count() * 3);
+    std::uniform_int_distribution<std::chrono::milliseconds::rep> pick(base.count(), high);
+    return std::min(cap, std::chrono::milliseconds(pick(rng)));
+}
+
+Retry::Outcome Retry::run(const Policy& policy, const std::function<Outcome(int)>& attemptFn)
+{
+    Outcome outcome = Outcome::Transient;
+    std::chrono::milliseconds delay = policy.base;
+    for (int attempt = 1; attempt <= policy.maxAttempts; ++attempt) {
+        if (policy.breaker && !policy.breaker->allow()) return Outcome::Rejected;
+        outcome = attemptFn(attempt);
+        if (policy.breaker) {
+            // Contention or a permanent error still means the endpoint answered
+            if (outcome == Outcome::Unavailable) {
+                policy.breaker->recordFailure();
+            } else {
+                policy.breaker->recordSuccess();
+            }
+        }
+        const bool retry = outcome == Outcome::Transient || outcome == Outcome::Unavailable;
+        if (!retry || attempt == policy.maxAttempts) break;
+        delay = nextDelay(delay, policy.base, policy.cap);
         std::this_thread::sleep_for(delay);
-        delay *= 2;
-        ++attempt;
     }
+    return outcome;
 }
 
-} // namespace SyncLayer::Utils
-
+void Retry::withExponentialBackoff(int maxAttempts, std::function<bool(int)> attemptFn)
+{
+    Policy policy;
+    policy.maxAttempts = maxAttempts;
+    run(policy, [&attemptFn](int attempt) { return attemptFn(attempt) ? Outcome::Succeeded : Outcome::Transient; });
+}
 
+} // namespace SyncLayer::Utils
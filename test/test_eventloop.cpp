@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include "db/Async.hpp"
+#include "db/DBConnection.hpp"
+#include "db/EventLoop.hpp"
+#include "db/Watchdog.hpp"
+#include <atomic>
+#include <thread>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+using SyncLayer::DB::EventLoop;
+using SyncLayer::DB::Task;
+
+TEST(EventLoopTest, DispatchesReadyDescriptorsUntilUnwatched) {
+    int a[2], b[2];
+    ASSERT_EQ(pipe(a), 0);
+    ASSERT_EQ(pipe(b), 0);
+    EventLoop loop;
+    std::string seen;
+    auto reader = [&loop, &seen](int fd) {
+        return [&loop, &seen, fd](std::uint32_t events) {
+            ASSERT_TRUE(events & EPOLLIN);
+            char c;
+            ASSERT_EQ(read(fd, &c, 1), 1);
+            seen += c;
+            loop.unwatch(fd);
+        };
+    };
+    loop.watch(a[0], EPOLLIN, reader(a[0]));
+    loop.watch(b[0], EPOLLIN, reader(b[0]));
+    ASSERT_EQ(write(b[1], "b", 1), 1);
+    ASSERT_EQ(write(a[1], "a", 1), 1);
+    EXPECT_TRUE(loop.run(std::chrono::seconds(1)));
+    EXPECT_EQ(seen.size(), 2u);
+    EXPECT_EQ(loop.watched(), 0u);
+    for (int fd : { a[0], a[1], b[0], b[1] }) close(fd);
+}
+
+TEST(EventLoopTest, RunTimesOutWhileSomethingIsWatched) {
+    int p[2];
+    ASSERT_EQ(pipe(p), 0);
+    EventLoop loop;
+    loop.watch(p[0], EPOLLIN, [](std::uint32_t) {});
+    EXPECT_FALSE(loop.run(std::chrono::milliseconds(20)));
+    loop.unwatch(p[0]);
+    EXPECT_TRUE(loop.run(std::chrono::milliseconds(20)));
+    close(p[0]);
+    close(p[1]);
+}
+
+TEST(EventLoopTest, ConnectReportsRefusedConnections) {
+    EventLoop loop;
+    int calls = 0;
+    for (int i = 0; i < 3; ++i) {
+        loop.connect("host=127.0.0.1 port=1 connect_timeout=2",
+                     [&calls](std::unique_ptr<SyncLayer::DB::DBConnection> conn, const std::string& error) {
+                         ++calls;
+                         EXPECT_EQ(conn, nullptr);
+                         EXPECT_FALSE(error.empty());
+                     });
+    }
+    EXPECT_TRUE(loop.run(std::chrono::seconds(5)));
+    EXPECT_EQ(calls, 3);
+}
+
+// Resumes the awaiting coroutine once fd is readable, with the byte read
+struct ReadByte {
+    EventLoop& loop;
+    int fd;
+    char byte {0};
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> awaiting) {
+        loop.watch(fd, EPOLLIN, [this, awaiting](std::uint32_t) {
+            loop.unwatch(fd);
+            read(fd, &byte, 1);
+            awaiting.resume();
+        });
+    }
+    char await_resume() const { return byte; }
+};
+
+static Task<std::string> readTwo(EventLoop& loop, int fd) {
+    std::string out;
+    out += co_await ReadByte{ loop, fd };
+    out += co_await ReadByte{ loop, fd };
+    co_return out;
+}
+
+static Task<std::string> concat(EventLoop& loop, int a, int b) {
+    // Sequential code; the two reads interleave with other tasks on the loop
+    std::string first = co_await readTwo(loop, a);
+    co_return first + co_await readTwo(loop, b);
+}
+
+TEST(TaskTest, ChainsResumeFromTheLoop) {
+    int a[2], b[2];
+    ASSERT_EQ(pipe(a), 0);
+    ASSERT_EQ(pipe(b), 0);
+    EventLoop loop;
+    auto task = concat(loop, a[0], b[0]);
+    task.start();
+    EXPECT_FALSE(task.done());
+    ASSERT_EQ(write(b[1], "cd", 2), 2);
+    ASSERT_EQ(write(a[1], "ab", 2), 2);
+    EXPECT_TRUE(loop.run(std::chrono::seconds(1)));
+    ASSERT_TRUE(task.done());
+    EXPECT_EQ(task.result(), "abcd");
+    for (int fd : { a[0], a[1], b[0], b[1] }) close(fd);
+}
+
+TEST(WatchdogTest, FiresOnlyWhileArmed) {
+    SyncLayer::DB::Watchdog watchdog;
+    std::atomic<int> fired {0};
+    auto late = watchdog.arm(std::chrono::milliseconds(10), [&fired] { ++fired; });
+    {
+        auto early = watchdog.arm(std::chrono::milliseconds(10), [&fired] { fired += 10; });
+        EXPECT_FALSE(early.fired());
+    } // disarmed before its deadline
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_TRUE(late.fired());
+    EXPECT_EQ(fired.load(), 1);
+    late.disarm();
+    EXPECT_TRUE(late.fired());
+    EXPECT_FALSE(watchdog.arm(std::chrono::milliseconds(0), [] {}).fired());
+}
+
+TEST(WatchdogTest, SlowCallbackDoesNotBlockOtherGuards) {
+    SyncLayer::DB::Watchdog watchdog;
+    std::atomic<bool> started {false};
+    std::atomic<bool> finished {false};
+    auto stuck = watchdog.arm(std::chrono::milliseconds(1), [&] {
+        started = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(300)); // a cancel stuck on a dead network
+        finished = true;
+    });
+    while (!started) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    const auto before = std::chrono::steady_clock::now();
+    watchdog.arm(std::chrono::milliseconds(1000), [] {}).disarm();
+    EXPECT_LT(std::chrono::steady_clock::now() - before, std::chrono::milliseconds(100));
+    EXPECT_FALSE(finished);
+
+    // Its own guard waits for the callback, so nothing fires after disarm() returns
+    stuck.disarm();
+    EXPECT_TRUE(finished);
+    EXPECT_TRUE(stuck.fired());
+}
+
+TEST(WatchdogTest, SlowCallbackDoesNotDelayOtherExpiries) {
+    SyncLayer::DB::Watchdog watchdog;
+    std::atomic<bool> started {false};
+    std::atomic<bool> other {false};
+    auto stuck = watchdog.arm(std::chrono::milliseconds(1), [&] {
+        started = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    });
+    while (!started) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    // Another connection's deadline passes while the first cancel hangs; it still fires on time
+    auto guard = watchdog.arm(std::chrono::milliseconds(10), [&other] { other = true; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_TRUE(other);
+    EXPECT_TRUE(guard.fired());
+}
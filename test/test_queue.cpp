@@ -0,0 +1,533 @@
+#include <gtest/gtest.h>
+#include "queue/TransactionScheduler.hpp"
+#include "queue/RingBuffer.hpp"
+#include "queue/SegmentLog.hpp"
+#include "queue/SpillStore.hpp"
+#include "queue/ColumnBatch.hpp"
+#include "queue/LaneScheduler.hpp"
+#include "queue/MicroBatcher.hpp"
+#include "db/TypeCodec.hpp"
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+using SyncLayer::Queue::ColumnBatch;
+using SyncLayer::Queue::LaneScheduler;
+using SyncLayer::Queue::MicroBatcher;
+using SyncLayer::Queue::RingBuffer;
+using SyncLayer::Queue::SegmentLog;
+using SyncLayer::Queue::SpillStore;
+using SyncLayer::Queue::TransactionScheduler;
+using SyncLayer::Tracker::ChangeEvent;
+using SyncLayer::Tracker::ColumnPayload;
+using SyncLayer::Tracker::TableRegistry;
+using SyncLayer::Utils::Arena;
+
+static ChangeEvent change(const std::string& table, const std::string& key, std::uint64_t txId,
+                          std::uint64_t lsn = 0) {
+    auto arena = std::make_shared<Arena>();
+    const char* values[2] = { key.c_str(), nullptr };
+    const int lengths[2] = { static_cast<int>(key.size()), 0 };
+    ChangeEvent ev;
+    ev.table = TableRegistry::intern(table);
+    ev.op = SyncLayer::Tracker::Op::Update;
+    ev.txId = txId;
+    ev.lsn = lsn;
+    ev.key = arena->copy(key);
+    ev.payload = ColumnPayload::pack(*arena, values, lengths, 2);
+    ev.arena = arena;
+    return ev;
+}
+
+TEST(ChangeEventTest, ColumnPayloadRoundTrip) {
+    Arena arena(64);
+    const char* values[3] = { "42", nullptr, "" };
+    const int lengths[3] = { 2, 0, 0 };
+    auto payload = ColumnPayload::pack(arena, values, lengths, 3);
+
+    std::vector<const char*> out;
+    std::vector<int> outLengths;
+    ASSERT_TRUE(ColumnPayload::unpack(payload, out, outLengths));
+    ASSERT_EQ(out.size(), 3u);
+    EXPECT_STREQ(out[0], "42");
+    EXPECT_EQ(out[1], nullptr);
+    EXPECT_STREQ(out[2], "");
+    EXPECT_EQ(outLengths[0], 2);
+
+    out.clear();
+    EXPECT_FALSE(ColumnPayload::unpack(payload.substr(0, payload.size() - 1), out, outLengths));
+}
+
+TEST(ChangeEventTest, TableIdsAreStable) {
+    auto orders = TableRegistry::intern("public.orders");
+    EXPECT_EQ(TableRegistry::intern(std::string("public.") + "orders"), orders);
+    EXPECT_NE(TableRegistry::intern("public.items"), orders);
+    EXPECT_EQ(TableRegistry::name(orders), "public.orders");
+}
+
+TEST(TransactionSchedulerTest, GroupsEventsByTransaction) {
+    TransactionScheduler scheduler({
+        change("public.orders", "1", 10),
+        change("public.orders", "2", 10),
+        change("public.items", "7", 11),
+    });
+    ASSERT_EQ(scheduler.size(), 2u);
+    EXPECT_EQ(scheduler.transaction(0).events.size(), 2u);
+    EXPECT_EQ(scheduler.transaction(1).txId, 11u);
+}
+
+TEST(TransactionSchedulerTest, OverlappingWriteSetsDependOnLatestWriter) {
+    TransactionScheduler scheduler({
+        change("public.orders", "1", 1),
+        change("public.orders", "2", 2),
+        change("public.orders", "1", 3),
+        change("public.orders", "2", 3),
+        change("public.items", "1", 4),
+    });
+    ASSERT_EQ(scheduler.size(), 4u);
+    EXPECT_TRUE(scheduler.transaction(0).dependsOn.empty());
+    EXPECT_TRUE(scheduler.transaction(1).dependsOn.empty());
+    EXPECT_EQ(scheduler.transaction(2).dependsOn, (std::vector<size_t>{0, 1}));
+    // Same key value in a different table is not a conflict
+    EXPECT_TRUE(scheduler.transaction(3).dependsOn.empty());
+}
+
+TEST(TransactionSchedulerTest, ChainsStayOnOneWorker) {
+    TransactionScheduler scheduler({
+        change("public.orders", "1", 1),
+        change("public.orders", "2", 2),
+        change("public.orders", "1", 3),
+        change("public.orders", "1", 4),
+    });
+    auto workers = scheduler.assign(2);
+    EXPECT_NE(workers[0], workers[1]);
+    EXPECT_EQ(workers[2], workers[0]);
+    EXPECT_EQ(workers[3], workers[0]);
+}
+
+TEST(TransactionSchedulerTest, HeldBackTransactionsHoldBackTheirDependents) {
+    TransactionScheduler scheduler({
+        change("public.orders", "1", 1),
+        change("public.orders", "2", 2),
+        change("public.orders", "1", 3),
+        change("public.orders", "3", 4),
+    });
+    ASSERT_EQ(scheduler.size(), 4u);
+    EXPECT_TRUE(scheduler.waitForDependencies(0));
+    scheduler.markDone(0, true); // e.g. timed out, to be retried
+    EXPECT_TRUE(scheduler.waitForDependencies(1));
+    scheduler.markDone(1);
+    EXPECT_FALSE(scheduler.waitForDependencies(2));
+    scheduler.markDone(2, true);
+    EXPECT_TRUE(scheduler.waitForDependencies(3));
+}
+
+TEST(TransactionSchedulerTest, OldestPendingLsnSkipsDoneTransactions) {
+    TransactionScheduler scheduler({
+        change("public.orders", "1", 1, 10),
+        change("public.orders", "2", 2, 20),
+        change("public.orders", "3", 2, 21),
+        change("public.items", "1", 3, 30),
+    });
+    ASSERT_EQ(scheduler.size(), 3u);
+    // Transaction 2 commits on one worker while 1 still runs on another: it may not record past 9
+    EXPECT_EQ(scheduler.oldestPendingLsn(1), 10u);
+    EXPECT_EQ(scheduler.oldestPendingLsn(0), 20u);
+    scheduler.markDone(0);
+    EXPECT_EQ(scheduler.oldestPendingLsn(1), 30u);
+    scheduler.markDone(2);
+    EXPECT_EQ(scheduler.oldestPendingLsn(1), UINT64_MAX);
+}
+
+TEST(RingBufferTest, RoundsCapacityAndRejectsWhenFull) {
+    RingBuffer<int> ring(3);
+    EXPECT_EQ(ring.capacity(), 4u);
+    for (int i = 0; i < 4; ++i) EXPECT_TRUE(ring.tryPush(int(i)));
+    EXPECT_FALSE(ring.tryPush(4));
+
+    int out = -1;
+    ASSERT_TRUE(ring.tryPop(out));
+    EXPECT_EQ(out, 0);
+    EXPECT_TRUE(ring.tryPush(4));
+}
+
+TEST(RingBufferTest, BatchPushIsPartialWhenNearlyFull) {
+    RingBuffer<int> ring(4);
+    std::vector<int> items {1, 2, 3, 4, 5, 6};
+    EXPECT_EQ(ring.tryPushBatch(items.data(), items.size()), 4u);
+
+    std::vector<int> out;
+    EXPECT_EQ(ring.tryPopBatch(out, 10), 4u);
+    EXPECT_EQ(out, (std::vector<int>{1, 2, 3, 4}));
+    EXPECT_EQ(ring.sizeApprox(), 0u);
+}
+
+TEST(RingBufferTest, MultipleProducersKeepPerProducerOrder) {
+    constexpr int producers = 4;
+    constexpr int perProducer = 20000;
+    RingBuffer<int> ring(256);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&ring, p] {
+            for (int i = 0; i < perProducer; ++i) {
+                int value = p * perProducer + i;
+                while (!ring.tryPush(std::move(value))) std::this_thread::yield();
+            }
+        });
+    }
+
+    std::vector<int> last(producers, -1);
+    std::vector<int> batch;
+    int received = 0;
+    while (received < producers * perProducer) {
+        batch.clear();
+        received += static_cast<int>(ring.tryPopBatch(batch, 64));
+        for (int v : batch) {
+            int p = v / perProducer;
+            EXPECT_GT(v, last[p]);
+            last[p] = v;
+        }
+    }
+    for (auto& t : threads) t.join();
+    EXPECT_EQ(received, producers * perProducer);
+}
+
+static std::string freshDir(const std::string& name) {
+    auto dir = std::filesystem::temp_directory_path() / name;
+    std::filesystem::remove_all(dir);
+    return dir.string();
+}
+
+TEST(SegmentLogTest, ReplaysUncommittedEventsAfterReopen) {
+    const std::string dir = freshDir("synclayer_segmentlog_replay");
+    {
+        SegmentLog log(dir, 4096);
+        for (std::uint64_t i = 1; i <= 100; ++i) {
+            log.append(change("public.orders", std::to_string(i), i, i));
+        }
+        std::vector<ChangeEvent> batch;
+        ASSERT_EQ(log.readBatch(batch, 40), 40u);
+        log.commit();
+        batch.clear();
+        ASSERT_EQ(log.readBatch(batch, 10), 10u); // read but never committed
+    }
+
+    SegmentLog log(dir, 4096);
+    EXPECT_EQ(log.lastLsn(), 100u);
+    std::vector<ChangeEvent> batch;
+    EXPECT_EQ(log.readBatch(batch, 1000), 60u);
+    EXPECT_EQ(batch.front().lsn, 41u);
+    EXPECT_EQ(batch.back().key, "100");
+    EXPECT_EQ(TableRegistry::name(batch.back().table), "public.orders");
+    std::filesystem::remove_all(dir);
+}
+
+TEST(SegmentLogTest, DiscardedBacklogStaysGoneAfterReopen) {
+    const std::string dir = freshDir("synclayer_segmentlog_discard");
+    {
+        SegmentLog log(dir, 1024);
+        for (std::uint64_t i = 1; i <= 50; ++i) log.append(change("public.orders", std::to_string(i), i, i));
+        std::vector<ChangeEvent> batch;
+        ASSERT_EQ(log.readBatch(batch, 10), 10u);
+        log.commit();
+    }
+    {
+        // A restart finds no progress on the target, so the initial sync supersedes the backlog
+        SegmentLog log(dir, 1024);
+        EXPECT_EQ(log.lastLsn(), 50u);
+        log.discard();
+        EXPECT_EQ(log.lastLsn(), 0u);
+        log.append(change("public.orders", "1", 1, 1));
+    }
+
+    SegmentLog log(dir, 1024);
+    std::vector<ChangeEvent> batch;
+    ASSERT_EQ(log.readBatch(batch, 1000), 1u);
+    EXPECT_EQ(batch.front().lsn, 1u);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(SegmentLogTest, RecycledSegmentsDoNotResurfaceOldRecords) {
+    const std::string dir = freshDir("synclayer_segmentlog_recycle");
+    SegmentLog log(dir, 1024);
+    std::uint64_t lsn = 0;
+    for (int round = 0; round < 5; ++round) {
+        for (int i = 0; i < 30; ++i) {
+            ++lsn;
+            log.append(change("public.orders", std::to_string(lsn), lsn, lsn));
+        }
+        std::vector<ChangeEvent> batch;
+        ASSERT_EQ(log.readBatch(batch, 1000), 30u);
+        EXPECT_EQ(batch.front().lsn, lsn - 29);
+        log.commit();
+    }
+    std::vector<ChangeEvent> batch;
+    EXPECT_EQ(log.readBatch(batch, 1000), 0u);
+    std::filesystem::remove_all(dir);
+}
+
+static ChangeEvent row(const std::shared_ptr<Arena>& arena, const char* id, const char* name) {
+    const char* values[2] = { id, name };
+    const int lengths[2] = { static_cast<int>(std::strlen(id)), name ? static_cast<int>(std::strlen(name)) : 0 };
+    ChangeEvent ev;
+    ev.table = TableRegistry::intern("public.users");
+    ev.key = arena->copy(id);
+    ev.payload = ColumnPayload::pack(*arena, values, lengths, 2);
+    ev.arena = arena;
+    return ev;
+}
+
+TEST(ColumnBatchTest, TransposesAndCoalescesByKey) {
+    namespace TypeOid = SyncLayer::DB::TypeOid;
+    auto arena = std::make_shared<Arena>();
+    ColumnBatch batch(TableRegistry::intern("public.users"), { TypeOid::Int4, 25 });
+    ASSERT_TRUE(batch.append(row(arena, "1", "ann")));
+    ASSERT_TRUE(batch.append(row(arena, "2", nullptr)));
+    ASSERT_TRUE(batch.append(row(arena, "1", "a\"b")));
+    EXPECT_FALSE(batch.append(row(arena, "x", "bad int")));
+    ASSERT_EQ(batch.rows(), 3u);
+
+    batch.coalesce();
+    ASSERT_EQ(batch.rows(), 2u);
+    const auto& ids = batch.column(0);
+    EXPECT_EQ(ids.width, 4u);
+    EXPECT_EQ(ids.data, std::string("\0\0\0\2\0\0\0\1", 8));
+    EXPECT_FALSE(batch.column(1).isValid(0));
+    EXPECT_TRUE(batch.column(1).isValid(1));
+
+    std::string out;
+    EXPECT_EQ(batch.writeArray(1, out), 0);
+    EXPECT_EQ(out, "{NULL,\"a\\\"b\"}");
+    EXPECT_EQ(batch.writeArray(0, out), 1);
+    EXPECT_EQ(out.size(), 20u + 2 * (4 + 4));
+}
+
+TEST(ColumnBatchTest, StatementRunsKeepOrderAcrossTables) {
+    // Parent, child, parent, child, child: a merged parent statement would run ahead of the first child
+    const std::vector<ChangeEvent> txn = {
+        change("public.orders", "1", 7), change("public.items", "1", 7), change("public.orders", "2", 7),
+        change("public.items", "2", 7), change("public.items", "3", 7),
+    };
+    std::vector<const ChangeEvent*> events;
+    for (const auto& ev : txn) events.push_back(&ev);
+
+    const auto runs = SyncLayer::Queue::statementRuns(events);
+    ASSERT_EQ(runs.size(), 4u);
+    EXPECT_EQ(runs[0], (std::vector<const ChangeEvent*>{ &txn[0] }));
+    EXPECT_EQ(runs[1], (std::vector<const ChangeEvent*>{ &txn[1] }));
+    EXPECT_EQ(runs[2], (std::vector<const ChangeEvent*>{ &txn[2] }));
+    EXPECT_EQ(runs[3], (std::vector<const ChangeEvent*>{ &txn[3], &txn[4] }));
+}
+
+TEST(ColumnBatchTest, DeletesRunApartFromUpserts) {
+    std::vector<ChangeEvent> txn = {
+        change("public.orders", "1", 7), change("public.orders", "2", 7), change("public.orders", "1", 7),
+        change("public.orders", "3", 7),
+    };
+    txn[2].op = SyncLayer::Tracker::Op::Delete;
+    std::vector<const ChangeEvent*> events;
+    for (const auto& ev : txn) events.push_back(&ev);
+
+    // Upsert 1 then delete 1: one statement for both would leave the row behind
+    const auto runs = SyncLayer::Queue::statementRuns(events);
+    ASSERT_EQ(runs.size(), 3u);
+    EXPECT_EQ(runs[0].size(), 2u);
+    EXPECT_EQ(runs[1], (std::vector<const ChangeEvent*>{ &txn[2] }));
+    EXPECT_EQ(runs[2], (std::vector<const ChangeEvent*>{ &txn[3] }));
+}
+
+TEST(SpillStoreTest, ReadsBatchesBackInOrderWithinBudget) {
+    const std::string dir = freshDir("synclayer_spill");
+    SpillStore spill(dir, 64 * 1024);
+    std::vector<ChangeEvent> first, second;
+    for (std::uint64_t i = 1; i <= 50; ++i) first.push_back(change("public.orders", std::to_string(i), 0, i));
+    second.push_back(change("public.items", "7", 0, 51));
+    ASSERT_TRUE(spill.write(first));
+    ASSERT_TRUE(spill.write(second));
+    EXPECT_GT(spill.diskBytes(), 0u);
+
+    std::vector<ChangeEvent> huge(5000, change("public.orders", "1", 0, 1));
+    EXPECT_FALSE(spill.write(huge));
+
+    std::vector<ChangeEvent> out;
+    ASSERT_TRUE(spill.readNext(out));
+    ASSERT_EQ(out.size(), 50u);
+    EXPECT_EQ(out.back().key, "50");
+    out.clear();
+    ASSERT_TRUE(spill.readNext(out));
+    EXPECT_EQ(TableRegistry::name(out.front().table), "public.items");
+    EXPECT_FALSE(spill.readNext(out));
+    EXPECT_TRUE(spill.empty());
+    std::filesystem::remove_all(dir);
+}
+
+TEST(LaneSchedulerTest, SharesRoundsByWeightAndKeepsTableOrder) {
+    LaneScheduler lanes({ { "public.orders", { 3, 0 } } });
+    const auto now = LaneScheduler::Clock::now();
+    std::uint64_t lsn = 0;
+    for (int i = 0; i < 200; ++i) lanes.push(change("public.audit_log", std::to_string(i), 0, ++lsn), now);
+    for (int i = 0; i < 200; ++i) lanes.push(change("public.orders", std::to_string(i), 0, ++lsn), now);
+
+    std::vector<ChangeEvent> round;
+    ASSERT_EQ(lanes.next(round, 128), 128u);
+    size_t orders = 0;
+    std::uint64_t lastOrders = 0;
+    for (const auto& ev : round) {
+        if (TableRegistry::name(ev.table) != "public.orders") continue;
+        ++orders;
+        EXPECT_GT(ev.lsn, lastOrders);
+        lastOrders = ev.lsn;
+    }
+    EXPECT_EQ(orders, 96u);
+    EXPECT_EQ(lanes.minPendingLsn(), 33u);
+}
+
+TEST(LaneSchedulerTest, ServesLagObjectiveLanesFirst) {
+    LaneScheduler lanes({ { "public.orders", { 1, 500 } } });
+    const auto now = LaneScheduler::Clock::now();
+    for (int i = 0; i < 1000; ++i) lanes.push(change("public.audit_log", std::to_string(i), 0, i + 1), now);
+    lanes.push(change("public.orders", "1", 0, 1001), now);
+
+    std::vector<ChangeEvent> round;
+    lanes.next(round, 10);
+    ASSERT_FALSE(round.empty());
+    EXPECT_EQ(TableRegistry::name(round.front().table), "public.orders");
+    EXPECT_EQ(lanes.size(), 991u);
+}
+
+TEST(LaneSchedulerTest, HeavyBacklogCannotStarveOtherLanesAcrossRounds) {
+    // As apply reads the queue ahead: a bulk load first, the other tables' changes behind it
+    const size_t roundBytes = 64 * change("public.audit_log", "0000", 0).footprint();
+    LaneScheduler lanes({ { "public.orders", { 2, 0 } }, { "public.payments", { 1, 200 } } }, roundBytes);
+    const auto now = LaneScheduler::Clock::now();
+    std::uint64_t lsn = 0;
+    for (int i = 0; i < 2000; ++i) lanes.push(change("public.audit_log", std::to_string(i), 0, ++lsn), now);
+    for (int i = 0; i < 100; ++i) {
+        lanes.push(change("public.orders", std::to_string(i), 0, ++lsn), now);
+        lanes.push(change("public.payments", std::to_string(i), 0, ++lsn), now);
+    }
+
+    // Each round is one micro-batch: the lag-bound lane gets up to half, then orders
+    // takes twice the bulk load's share, round after round until both are done
+    std::vector<ChangeEvent> round;
+    size_t rounds = 0;
+    size_t audit = 0;
+    while (lanes.size() > 2000 - audit) {
+        round.clear();
+        ASSERT_GT(lanes.next(round, 1000, now), 0u);
+        ++rounds;
+        size_t bytes = 0;
+        size_t orders = 0;
+        size_t payments = 0;
+        for (const auto& ev : round) {
+            bytes += ev.footprint();
+            const auto name = TableRegistry::name(ev.table);
+            if (name == "public.audit_log") ++audit;
+            if (name == "public.orders") ++orders;
+            if (name == "public.payments") ++payments;
+        }
+        EXPECT_LE(bytes, roundBytes);
+        EXPECT_GT(orders + payments, round.size() / 2) << "round " << rounds;
+    }
+    EXPECT_LE(rounds, 6u);
+    EXPECT_GT(2000 - audit, 1800u);
+}
+
+TEST(LaneSchedulerTest, ParksDeferredLanesUntilTheirRetryIsDue) {
+    LaneScheduler lanes({});
+    const auto now = LaneScheduler::Clock::now();
+    for (int i = 0; i < 4; ++i) lanes.push(change("public.orders", std::to_string(i), 0, i + 1), now);
+    for (int i = 0; i < 4; ++i) lanes.push(change("public.audit_log", std::to_string(i), 0, i + 5), now);
+
+    std::vector<ChangeEvent> round;
+    ASSERT_EQ(lanes.next(round, 2, now), 2u);
+    ASSERT_EQ(TableRegistry::name(round.front().table), "public.orders");
+    lanes.defer(std::move(round), now);
+    lanes.push(change("public.orders", "4", 0, 9), now);
+    EXPECT_EQ(lanes.parked(), 1u);
+    EXPECT_EQ(lanes.minPendingLsn(), 1u);
+
+    // Other lanes keep flowing while orders waits out its backoff
+    round.clear();
+    EXPECT_EQ(lanes.next(round, 16, now), 4u);
+    for (const auto& ev : round) EXPECT_EQ(TableRegistry::name(ev.table), "public.audit_log");
+    round.clear();
+    EXPECT_EQ(lanes.next(round, 16, now), 0u);
+
+    // Due again, in the original order with the newer event behind
+    round.clear();
+    ASSERT_EQ(lanes.next(round, 16, now + std::chrono::seconds(11)), 5u);
+    EXPECT_EQ(lanes.parked(), 0u);
+    for (size_t i = 0; i < round.size(); ++i) EXPECT_EQ(round[i].lsn, i < 4 ? i + 1 : 9u);
+    EXPECT_TRUE(lanes.empty());
+}
+
+TEST(LaneSchedulerTest, DeferredEventsReturnInSourceOrder) {
+    LaneScheduler lanes({});
+    const auto now = LaneScheduler::Clock::now();
+    // As merged from two workers' slots
+    std::vector<ChangeEvent> failed;
+    for (std::uint64_t lsn : { 2, 4, 1, 3 }) failed.push_back(change("public.orders", std::to_string(lsn), 0, lsn));
+    lanes.defer(std::move(failed), now);
+    EXPECT_EQ(lanes.minPendingLsn(), 1u);
+
+    std::vector<ChangeEvent> round;
+    ASSERT_EQ(lanes.next(round, 16, now + std::chrono::seconds(11)), 4u);
+    for (size_t i = 0; i < round.size(); ++i) EXPECT_EQ(round[i].lsn, i + 1);
+}
+
+TEST(TimerWheelTest, FiresItemsOnceDueAcrossLevels) {
+    using Wheel = SyncLayer::Utils::TimerWheel<int>;
+    const auto start = Wheel::Clock::now();
+    Wheel wheel(std::chrono::milliseconds(1), start);
+    wheel.schedule(std::chrono::milliseconds(5), 1, start);
+    wheel.schedule(std::chrono::milliseconds(300), 2, start);
+    wheel.schedule(std::chrono::milliseconds(70000), 3, start);
+    EXPECT_EQ(wheel.nextDue(), start + std::chrono::milliseconds(5));
+
+    std::vector<int> fired;
+    EXPECT_EQ(wheel.advance(start + std::chrono::milliseconds(4), fired), 0u);
+    EXPECT_EQ(wheel.advance(start + std::chrono::milliseconds(5), fired), 1u);
+    EXPECT_EQ(wheel.nextDue(), start + std::chrono::milliseconds(300));
+    EXPECT_EQ(wheel.advance(start + std::chrono::milliseconds(299), fired), 0u);
+    EXPECT_EQ(wheel.advance(start + std::chrono::milliseconds(69999), fired), 1u);
+    EXPECT_EQ(wheel.advance(start + std::chrono::milliseconds(70000), fired), 1u);
+    EXPECT_EQ(fired, (std::vector<int>{ 1, 2, 3 }));
+    EXPECT_TRUE(wheel.empty());
+}
+
+TEST(MicroBatcherTest, CutsAtEventLimitAndKeepsTransactionsWhole) {
+    MicroBatcher loose(3, 1 << 20, std::chrono::milliseconds(100), false);
+    std::vector<ChangeEvent> out;
+    EXPECT_FALSE(loose.add(change("public.t", "1", 1), out));
+    EXPECT_FALSE(loose.add(change("public.t", "2", 1), out));
+    ASSERT_TRUE(loose.add(change("public.t", "3", 1), out));
+    EXPECT_EQ(out.size(), 3u);
+    EXPECT_TRUE(loose.empty());
+
+    // Same limit, but the batch only ends where the transaction does
+    MicroBatcher whole(3, 1 << 20, std::chrono::milliseconds(100), true);
+    out.clear();
+    for (int i = 0; i < 4; ++i) EXPECT_FALSE(whole.add(change("public.t", std::to_string(i), 7), out));
+    ASSERT_TRUE(whole.add(change("public.t", "9", 8), out));
+    EXPECT_EQ(out.size(), 4u);
+    out.clear();
+    ASSERT_TRUE(whole.flush(out));
+    EXPECT_EQ(out.size(), 1u);
+    EXPECT_FALSE(whole.flush(out));
+}
+
+TEST(MicroBatcherTest, DueOnAnyTrigger) {
+    MicroBatcher batcher(100, 4096, std::chrono::milliseconds(50), false);
+    EXPECT_FALSE(batcher.due(0, 0, std::chrono::milliseconds(1000)));
+    EXPECT_FALSE(batcher.due(10, 100, std::chrono::milliseconds(10)));
+    EXPECT_TRUE(batcher.due(100, 100, std::chrono::milliseconds(10)));
+    EXPECT_TRUE(batcher.due(10, 4096, std::chrono::milliseconds(10)));
+    EXPECT_TRUE(batcher.due(10, 100, std::chrono::milliseconds(50)));
+
+    // The byte limit cuts a batch before the event limit does
+    std::vector<ChangeEvent> out;
+    const auto big = change("public.t", std::string(4096, 'k'), 0);
+    ASSERT_TRUE(batcher.add(ChangeEvent(big), out));
+    EXPECT_EQ(out.size(), 1u);
+}
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include "db/Result.hpp"
+#include <cstdint>
+#include <cstring>
+
+using SyncLayer::DB::Result;
+
+// A two-column result built without a server: (id int8, name text)
+static PGresult* makeResult(std::initializer_list<std::pair<const char*, const char*>> rows) {
+    PGresult* res = PQmakeEmptyPGresult(nullptr, PGRES_TUPLES_OK);
+    PGresAttDesc attrs[2] = {};
+    attrs[0].name = const_cast<char*>("id");
+    attrs[0].typid = 20;
+    attrs[1].name = const_cast<char*>("name");
+    attrs[1].typid = 25;
+    PQsetResultAttrs(res, 2, attrs);
+    int r = 0;
+    for (const auto& [id, name] : rows) {
+        PQsetvalue(res, r, 0, const_cast<char*>(id), id ? static_cast<int>(std::strlen(id)) : -1);
+        PQsetvalue(res, r, 1, const_cast<char*>(name), name ? static_cast<int>(std::strlen(name)) : -1);
+        ++r;
+    }
+    return res;
+}
+
+TEST(ResultTest, TypedAccessorsParseInPlace) {
+    const Result res(makeResult({ { "42", "alice" }, { "-7", nullptr }, { "x1", "" } }));
+    ASSERT_TRUE(res.ok());
+    ASSERT_EQ(res.rows(), 3);
+    EXPECT_EQ(res.get<std::int64_t>(0, 0), 42);
+    EXPECT_EQ(res.get<int>(1, "id"), -7);
+    EXPECT_EQ(res.get<long>(2, "id", -1), -1); // not a number
+    EXPECT_EQ(res.value(0, 1), "alice");
+    EXPECT_TRUE(res.isNull(1, 1));
+    EXPECT_EQ(res.get<std::string>(1, 1, "none"), "none");
+    EXPECT_FALSE(res.isNull(2, 1));
+    EXPECT_EQ(res.get<std::string>(2, 1, "none"), "");
+    EXPECT_EQ(res.column("name"), 1);
+    EXPECT_EQ(res.column("missing"), -1);
+}
+
+TEST(ResultTest, MovesOwnership) {
+    Result a(makeResult({ { "1", "a" } }));
+    Result b(std::move(a));
+    EXPECT_FALSE(a);
+    EXPECT_TRUE(b.ok());
+    a = std::move(b);
+    EXPECT_EQ(a.get<int>(0, 0), 1);
+    PQclear(a.release());
+    EXPECT_FALSE(a.ok());
+    EXPECT_FALSE(Result().ok());
+}
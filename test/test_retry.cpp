@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include "utils/Retry.hpp"
+#include "utils/CircuitBreaker.hpp"
+#include "db/Result.hpp"
+#include <chrono>
+#include <thread>
+
+using SyncLayer::Utils::CircuitBreaker;
+using SyncLayer::Utils::Retry;
+
+static Retry::Policy fastPolicy(int maxAttempts, CircuitBreaker* breaker = nullptr) {
+    Retry::Policy policy;
+    policy.maxAttempts = maxAttempts;
+    policy.base = std::chrono::milliseconds(1);
+    policy.cap = std::chrono::milliseconds(2);
+    policy.breaker = breaker;
+    return policy;
+}
+
+TEST(RetryPolicyTest, RetriesOnlyTransientFailures) {
+    int attempts = 0;
+    auto outcome = Retry::run(fastPolicy(5), [&](int) {
+        return ++attempts < 3 ? Retry::Outcome::Transient : Retry::Outcome::Succeeded;
+    });
+    EXPECT_EQ(outcome, Retry::Outcome::Succeeded);
+    EXPECT_EQ(attempts, 3);
+
+    attempts = 0;
+    outcome = Retry::run(fastPolicy(5), [&](int) {
+        ++attempts;
+        return Retry::Outcome::Permanent;
+    });
+    EXPECT_EQ(outcome, Retry::Outcome::Permanent);
+    EXPECT_EQ(attempts, 1);
+}
+
+TEST(RetryPolicyTest, DecorrelatedJitterStaysInBounds) {
+    const std::chrono::milliseconds base(100), cap(1000);
+    auto delay = base;
+    for (int i = 0; i < 200; ++i) {
+        const auto next = Retry::nextDelay(delay, base, cap);
+        EXPECT_GE(next, base);
+        EXPECT_LE(next, std::min(cap, delay * 3));
+        delay = next;
+    }
+}
+
+TEST(RetryPolicyTest, ClassifiesSqlstates) {
+    using SyncLayer::DB::transientSqlstate;
+    EXPECT_TRUE(transientSqlstate(""));       // lost connection
+    EXPECT_TRUE(transientSqlstate("08006"));  // connection failure
+    EXPECT_TRUE(transientSqlstate("40001"));  // serialization failure
+    EXPECT_TRUE(transientSqlstate("40P01"));  // deadlock
+    EXPECT_FALSE(transientSqlstate("42601")); // syntax error
+    EXPECT_FALSE(transientSqlstate("23505")); // unique violation
+}
+
+TEST(CircuitBreakerTest, ContentionDoesNotTripIt) {
+    using SyncLayer::DB::unavailableSqlstate;
+    EXPECT_TRUE(unavailableSqlstate(""));
+    EXPECT_TRUE(unavailableSqlstate("08006"));
+    EXPECT_TRUE(unavailableSqlstate("57P01")); // admin shutdown
+    EXPECT_FALSE(unavailableSqlstate("40001"));
+    EXPECT_FALSE(unavailableSqlstate("40P01"));
+    EXPECT_FALSE(unavailableSqlstate("55P03"));
+    EXPECT_FALSE(unavailableSqlstate("57014")); // statement timeout
+
+    // A busy but healthy target: every attempt deadlocks, many times over the threshold
+    CircuitBreaker breaker("test", 2, std::chrono::seconds(30));
+    int attempts = 0;
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(Retry::run(fastPolicy(4, &breaker), [&](int) {
+            ++attempts;
+            return Retry::Outcome::Transient;
+        }), Retry::Outcome::Transient);
+    }
+    EXPECT_EQ(attempts, 12);
+    EXPECT_EQ(breaker.state(), CircuitBreaker::State::Closed);
+}
+
+TEST(CircuitBreakerTest, OpensThenProbesAfterCooldown) {
+    CircuitBreaker breaker("test", 2, std::chrono::milliseconds(20));
+    int attempts = 0;
+    auto failing = [&](int) {
+        ++attempts;
+        return Retry::Outcome::Unavailable;
+    };
+    EXPECT_EQ(Retry::run(fastPolicy(5, &breaker), failing), Retry::Outcome::Rejected);
+    EXPECT_EQ(attempts, 2);
+    EXPECT_EQ(breaker.state(), CircuitBreaker::State::Open);
+    EXPECT_FALSE(breaker.allow());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    EXPECT_TRUE(breaker.allow()); // the trial call
+    EXPECT_FALSE(breaker.allow());
+    breaker.recordSuccess();
+    EXPECT_EQ(breaker.state(), CircuitBreaker::State::Closed);
+    EXPECT_TRUE(breaker.allow());
+}
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include "db/TypeCodec.hpp"
+
+using SyncLayer::DB::TypeCodec;
+namespace TypeOid = SyncLayer::DB::TypeOid;
+
+static std::string encode(TypeCodec::Encoder encoder, const std::string& text) {
+    std::string out;
+    EXPECT_TRUE(encoder(text.data(), text.size(), out)) << text;
+    return out;
+}
+
+static std::string bytes(std::initializer_list<int> values) {
+    std::string out;
+    for (int v : values) out.push_back(static_cast<char>(v));
+    return out;
+}
+
+TEST(TypeCodecTest, PicksEncoderByTypeOid) {
+    EXPECT_NE(TypeCodec::encoderFor(TypeOid::Int8), nullptr);
+    EXPECT_NE(TypeCodec::encoderFor(TypeOid::Numeric), nullptr);
+    EXPECT_EQ(TypeCodec::encoderFor(25 /* text */), nullptr);
+}
+
+TEST(TypeCodecTest, EncodesIntegersBigEndian) {
+    EXPECT_EQ(encode(TypeCodec::encodeInt2, "-2"), bytes({0xff, 0xfe}));
+    EXPECT_EQ(encode(TypeCodec::encodeInt4, "258"), bytes({0, 0, 1, 2}));
+    EXPECT_EQ(encode(TypeCodec::encodeInt8, "1"), bytes({0, 0, 0, 0, 0, 0, 0, 1}));
+
+    std::string out;
+    EXPECT_FALSE(TypeCodec::encodeInt2("70000", 5, out));
+    EXPECT_FALSE(TypeCodec::encodeInt4("12a", 3, out));
+    EXPECT_TRUE(out.empty());
+}
+
+TEST(TypeCodecTest, EncodesBoolAndFloat) {
+    EXPECT_EQ(encode(TypeCodec::encodeBool, "t"), bytes({1}));
+    EXPECT_EQ(encode(TypeCodec::encodeBool, "f"), bytes({0}));
+    EXPECT_EQ(encode(TypeCodec::encodeFloat8, "1.5"), bytes({0x3f, 0xf8, 0, 0, 0, 0, 0, 0}));
+    EXPECT_EQ(encode(TypeCodec::encodeFloat4, "-Infinity"), bytes({0xff, 0x80, 0, 0}));
+}
+
+TEST(TypeCodecTest, EncodesTimestampsAsMicrosecondsSince2000) {
+    EXPECT_EQ(encode(TypeCodec::encodeTimestamp, "2000-01-01 00:00:00"), bytes({0, 0, 0, 0, 0, 0, 0, 0}));
+    EXPECT_EQ(encode(TypeCodec::encodeTimestamp, "2000-01-01 00:00:01.5"), bytes({0, 0, 0, 0, 0, 0x16, 0xe3, 0x60}));
+    EXPECT_EQ(encode(TypeCodec::encodeTimestamp, "1999-12-31 23:59:59"),
+              bytes({0xff, 0xff, 0xff, 0xff, 0xff, 0xf0, 0xbd, 0xc0}));
+    EXPECT_EQ(encode(TypeCodec::encodeTimestampTz, "2000-01-01 01:00:00+01"), bytes({0, 0, 0, 0, 0, 0, 0, 0}));
+
+    std::string out;
+    const std::string bc = "0044-03-15 00:00:00 BC";
+    EXPECT_FALSE(TypeCodec::encodeTimestamp(bc.data(), bc.size(), out));
+}
+
+TEST(TypeCodecTest, EncodesUuid) {
+    EXPECT_EQ(encode(TypeCodec::encodeUuid, "00010203-0405-0607-0809-0a0b0c0d0e0f"),
+              bytes({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}));
+}
+
+TEST(TypeCodecTest, EncodesNumericInBase10000) {
+    // ndigits, weight, sign, dscale, digits...
+    EXPECT_EQ(encode(TypeCodec::encodeNumeric, "12345.67"),
+              bytes({0, 3, 0, 1, 0, 0, 0, 2, 0, 1, 0x09, 0x29, 0x1a, 0x2c}));
+    EXPECT_EQ(encode(TypeCodec::encodeNumeric, "-0.0001"),
+              bytes({0, 1, 0xff, 0xff, 0x40, 0, 0, 4, 0, 1}));
+    EXPECT_EQ(encode(TypeCodec::encodeNumeric, "0.00"), bytes({0, 0, 0, 0, 0, 0, 0, 2}));
+    EXPECT_EQ(encode(TypeCodec::encodeNumeric, "NaN"), bytes({0, 0, 0, 0, 0xc0, 0, 0, 0}));
+}